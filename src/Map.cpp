@@ -8,25 +8,69 @@
 #include<stdexcept>
 
 #include"goldchase.h"
+#include"cell_scan.h"
 #include"Screen.h"
 #include"Map.h"
 
 
-//Initialize the object and draw the map
-Map::Map(const unsigned char* mmem, int ylength, int xwidth) 
-  : mapHeight(ylength), mapWidth(xwidth), mapmem(mmem), theMap(ylength, xwidth)
+//Initialize the object and draw the map, or nothing at all under fog of war
+Map::Map(const Cell_planes& p, bool fog)
+  : mapHeight(p.get_rows()), mapWidth(p.get_cols()), planes(p), theMap(p.get_rows(), p.get_cols()),
+    shownFrame(fog ? p.get_cells() : 0, 0), frame(1)
 {
-  drawMap();
+  if(fog)
+    theMap.panelRefresh();
+  else
+    drawMap();
 }
 
 int Map::getKey()
 {
   return theMap.getKey();
 }
+bool Map::waitForInput(int timeout_ms)
+{
+  return theMap.waitForInput(timeout_ms);
+}
+std::vector<int> Map::readKeys()
+{
+  return theMap.readKeys();
+}
+bool Map::inputClosed()
+{
+  return theMap.inputClosed();
+}
+//Draw from other planes of the same size from now on
+void Map::setPlanes(const Cell_planes& p)
+{
+  if((int)p.get_rows()!=mapHeight || (int)p.get_cols()!=mapWidth)
+    throw std::invalid_argument("planes are not the size of the map");
+  planes=p;
+}
+void Map::setKeyTimeout(int ms)
+{
+  theMap.setKeyTimeout(ms);
+}
+unsigned long Map::getPlotCount()
+{
+  return theMap.getPlotCount();
+}
+unsigned long Map::getBytesWritten()
+{
+  return theMap.getBytesWritten();
+}
 void Map::postNotice(const char* msg)
 {
   theMap.notice(msg);
 }
+void Map::postToast(const char* msg)
+{
+  theMap.toast(msg);
+}
+void Map::updateToasts()
+{
+  theMap.expireToasts();
+}
 int Map::num_player_bits(unsigned char ch)
 {
   int count=0;
@@ -38,14 +82,14 @@ int Map::num_player_bits(unsigned char ch)
   return count;
 }
 
-//Calculate offset into memory array
-unsigned char Map::operator()(int y, int x)
+//Is there a wall at y, x
+bool Map::isWall(int y, int x)
 {
   if(y<0 || y>=mapHeight)
     throw std::out_of_range("Y coordinate out of range");
   if(x<0 || x>=mapWidth)
     throw std::out_of_range("X Coordinate out of range");
-  return *(mapmem+y*mapWidth+x);
+  return planes.is_wall(y*mapWidth+x);
 }
 
 unsigned int Map::getPlayer(unsigned int playerMask)
@@ -91,97 +135,176 @@ std::string Map::getMessage()
   return theMap.getText();
 }
 
-//Draw and refresh map from memory array
+//Plot the wall at y, x. The wall shape changes depending on the presence
+//or absence of walls in the surrounding squares
+void Map::plotWall(int y, int x)
+{
+  //determine what walls, if any, surround us
+  bool upper = y==0 ? true : isWall(y-1,x);
+  bool lower = y==mapHeight-1 ? true : isWall(y+1,x);
+  bool left = x==0 ? true : isWall(y,x-1);
+  bool right = x==mapWidth-1 ? true : isWall(y,x+1);
+  int num_walls=upper+lower+left+right;
+  switch(num_walls)
+  {
+    case 0:
+    case 4:
+      theMap.plot(y,x,ACS_PLUS);
+      break;
+    case 3:
+      if(!upper)
+        theMap.plot(y,x,ACS_TTEE);
+      if(!lower)
+        theMap.plot(y,x,ACS_BTEE);
+      if(!left)
+        theMap.plot(y,x,ACS_LTEE);
+      if(!right)
+        theMap.plot(y,x,ACS_RTEE);
+      break;
+    case 2:
+      if(!upper && !left)
+        theMap.plot(y,x,ACS_ULCORNER);
+      if(!lower && !left)
+        theMap.plot(y,x,ACS_LLCORNER);
+      if(!upper && !right)
+        theMap.plot(y,x,ACS_URCORNER);
+      if(!lower && !right)
+        theMap.plot(y,x,ACS_LRCORNER);
+      if(!lower && !upper)
+        theMap.plot(y,x,ACS_HLINE);
+      if(!left && !right)
+        theMap.plot(y,x,ACS_VLINE);
+      break;
+    case 1:
+      if(lower || upper)
+        theMap.plot(y,x,ACS_VLINE);
+      if(left || right)
+        theMap.plot(y,x,ACS_HLINE);
+      break;
+  } //end switch
+}
+
+//Plot whatever is at y, x
+void Map::drawCell(int y, int x)
+{
+  int cell=y*mapWidth+x;
+  unsigned char ch=planes.players(cell);
+
+  if(planes.is_wall(cell))
+    plotWall(y,x);
+  else if(ch & G_ANYP)
+  {
+    unsigned int player_color=A_STANDOUT;
+    if(num_player_bits(ch&G_ANYP) > 1)
+      player_color=COLOR_PAIR(Screen::c_overlap);
+
+    if(ch & G_PLR0) theMap.plot(y,x,'1',player_color);
+    else if(ch & G_PLR1) theMap.plot(y,x,'2',player_color);
+    else if(ch & G_PLR2) theMap.plot(y,x,'3',player_color);
+    else if(ch & G_PLR3) theMap.plot(y,x,'4',player_color);
+    else if(ch & G_PLR4) theMap.plot(y,x,'5',player_color);
+  }
+  else if(planes.gold(cell))
+    theMap.plot(y,x,'G',COLOR_PAIR(Screen::c_gold));
+  else
+    theMap.plot(y,x,' ');
+}
+
+//Draw and refresh map from the map planes
 void Map::drawMap()
 {
-  Map& mymap=*this; //ease referencing ourself
-  bool upper, lower, left, right;
   for(int y=0; y<mapHeight; ++y)
   {
     for(int x=0; x<mapWidth; ++x)
     {
-      unsigned char ch=mymap(y,x);
+      unsigned char ch=planes.players(y*mapWidth+x);
 
-      //Draw an empty square
-      if(ch==0)
+      //Draw a wall
+      if(isWall(y,x))
       {
-        theMap.plot(y,x,' ');
+        plotWall(y,x);
         continue;
       }
 
-      //Draw a wall
-      if(ch & G_WALL)
-      {
-        //determine what walls, if any, surround us
-        //the redundant &&true will force true values to 1
-        upper = y==0 ? true : mymap(y-1,x) & G_WALL && true;
-        lower = y==mapHeight-1 ? true : mymap(y+1,x) & G_WALL && true;
-        left = x==0 ? true : mymap(y,x-1) & G_WALL && true;
-        right = x==mapWidth-1 ? true : mymap(y,x+1) & G_WALL && true;
-        int num_walls=upper+lower+left+right;
-        // This switch statement plots the correct wall shape.
-        // The wall shape changes depending on the presence
-        // or absence of walls in the surrounding squares
-        switch(num_walls)
-        {
-          case 0:
-          case 4:
-            theMap.plot(y,x,ACS_PLUS);
-            break;
-          case 3:
-            if(!upper)
-              theMap.plot(y,x,ACS_TTEE);
-            if(!lower)
-              theMap.plot(y,x,ACS_BTEE);
-            if(!left)
-              theMap.plot(y,x,ACS_LTEE);
-            if(!right)
-              theMap.plot(y,x,ACS_RTEE);
-            break;
-          case 2:
-            if(!upper && !left)
-              theMap.plot(y,x,ACS_ULCORNER);
-            if(!lower && !left)
-              theMap.plot(y,x,ACS_LLCORNER);
-            if(!upper && !right)
-              theMap.plot(y,x,ACS_URCORNER);
-            if(!lower && !right)
-              theMap.plot(y,x,ACS_LRCORNER);
-            if(!lower && !upper)
-              theMap.plot(y,x,ACS_HLINE);
-            if(!left && !right)
-              theMap.plot(y,x,ACS_VLINE);
-            break;
-          case 1:
-            if(lower || upper)
-              theMap.plot(y,x,ACS_VLINE);
-            if(left || right)
-              theMap.plot(y,x,ACS_HLINE);
-            break;
-        } //end switch
-      }//end if ch & G_WALL
-
-      //Draw gold
-      if(ch & G_GOLD || ch & G_FOOL)
+      //Draw an empty square, gold is drawn over it below
+      if(ch==0)
       {
-        theMap.plot(y,x,'G',COLOR_PAIR(Screen::c_gold));
+        theMap.plot(y,x,' ');
+        continue;
       }
 
       //Draw player
-      if(ch & G_ANYP)
-      {
-        unsigned int player_color=A_STANDOUT;
-        if(num_player_bits(ch&G_ANYP) > 1)
-          player_color=COLOR_PAIR(Screen::c_overlap);
-
-        if(ch & G_PLR0) theMap.plot(y,x,'1',player_color);
-        else if(ch & G_PLR1) theMap.plot(y,x,'2',player_color);
-        else if(ch & G_PLR2) theMap.plot(y,x,'3',player_color);
-        else if(ch & G_PLR3) theMap.plot(y,x,'4',player_color);
-        else if(ch & G_PLR4) theMap.plot(y,x,'5',player_color);
-      }
+      drawCell(y,x);
 
     } //for(x...)
   } //for(y..)
+
+  //Draw gold, only the few cells in the gold set need looking at
+  const gold_set_S& gold=planes.get_gold_set();
+  for(unsigned int i=0; i<GOLD_SET_CAPACITY; ++i)
+  {
+    const gold_entry_S& e=gold.slots[i];
+    if(e.kind!=0 && planes.players(e.key-1)==0)
+      theMap.plot((e.key-1)/mapWidth,(e.key-1)%mapWidth,'G',COLOR_PAIR(Screen::c_gold));
+  }
+  theMap.panelRefresh();
+}
+
+//Draw only what changed since the last call: the cells whose players changed,
+//found a vector at a time by cell_diff(), and the gold cells if any gold came
+//or went. The first call draws the whole map.
+void Map::drawChanges()
+{
+  const unsigned char* players=planes.get_players();
+  const gold_set_S& gold=planes.get_gold_set();
+  size_t cells=planes.get_cells();
+  if(drawnPlayers.size()!=cells)
+  {
+    drawMap();
+    drawnPlayers.assign(players,players+cells);
+    drawnGold=gold;
+    dirty.resize(cells);
+    return;
+  }
+
+  size_t changed=cell_diff(drawnPlayers.data(),players,cells,dirty.data());
+  for(size_t k=0; k<changed; ++k)
+  {
+    drawCell(dirty[k]/mapWidth,dirty[k]%mapWidth);
+    drawnPlayers[dirty[k]]=players[dirty[k]];
+  }
+  if(std::memcmp(&gold,&drawnGold,sizeof(gold))!=0)
+  {
+    for(unsigned int i=0; i<GOLD_SET_CAPACITY; ++i)
+    {
+      if(gold.slots[i].key!=0)
+        drawCell((gold.slots[i].key-1)/mapWidth,(gold.slots[i].key-1)%mapWidth);
+      if(drawnGold.slots[i].key!=0 && drawnGold.slots[i].key!=gold.slots[i].key)
+        drawCell((drawnGold.slots[i].key-1)/mapWidth,(drawnGold.slots[i].key-1)%mapWidth);
+    }
+    drawnGold=gold;
+  }
+  theMap.panelRefresh();
+}
+
+//Fog of war: draw only the visible cells. Cells that went out of sight are
+//blanked, except walls, which never change and so stay drawn once seen.
+//Costs as much as the visible area, whatever the map size.
+void Map::drawVisible(const std::vector<unsigned int>& visible)
+{
+  ++frame;
+  for(unsigned int cell : visible)
+  {
+    //a wall that was already in sight is still drawn right
+    if(!(shownFrame[cell]==frame-1 && planes.is_wall(cell)))
+      drawCell(cell/mapWidth,cell%mapWidth);
+    shownFrame[cell]=frame;
+  }
+  for(unsigned int cell : shown)
+  {
+    if(shownFrame[cell]!=frame && !planes.is_wall(cell))
+      theMap.plot(cell/mapWidth,cell%mapWidth,' ');
+  }
+  shown=visible;
   theMap.panelRefresh();
 }
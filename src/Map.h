@@ -5,25 +5,47 @@
 #include<ncurses.h>
 #include<panel.h>
 #include "Screen.h"
+#include "cell_planes.h"
 
 /////
 // The Map class uses the Screen class to paint a map
 /////
 class Map {
   public:
-    Map(const unsigned char* mapmem, int l, int w);
+    Map(const Cell_planes& planes, bool fog=false);
     void drawMap();
+    void drawChanges();
+    void drawVisible(const std::vector<unsigned int>& visible);
     void postNotice(const char* msg);
+    void postToast(const char* msg);
+    void updateToasts();
     int getKey();
+    void setKeyTimeout(int ms);
+    bool waitForInput(int timeout_ms);
+    std::vector<int> readKeys();
+    bool inputClosed();
+    void setPlanes(const Cell_planes& p);
+    unsigned long getPlotCount();
+    unsigned long getBytesWritten();
     unsigned int getPlayer(unsigned int PlayerMask);
     std::string getMessage();
   private:
     int num_player_bits(unsigned char ch);
-    unsigned char operator()(int y, int x);
+    bool isWall(int y, int x);
+    void plotWall(int y, int x);
+    void drawCell(int y, int x);
     Screen theMap;
-    const unsigned char* mapmem;
+    Cell_planes planes;
     int mapHeight;
     int mapWidth;
+    //fog of war: cells shown last frame, and the frame each cell was last shown in
+    std::vector<unsigned int> shown;
+    std::vector<unsigned int> shownFrame;
+    unsigned int frame;
+    //drawChanges(): players and gold as last drawn, and room for the cells that differ
+    std::vector<unsigned char> drawnPlayers;
+    gold_set_S drawnGold;
+    std::vector<uint32_t> dirty;
 };
 
 #endif //MAP_H
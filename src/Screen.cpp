@@ -6,6 +6,10 @@
 #include<utility> //for std::pair
 #include<stdexcept>
 #include<unistd.h>
+#include<poll.h>
+#include<time.h>
+#include<fcntl.h>
+#include<string>
 
 #include"goldchase.h"
 #include"Screen.h"
@@ -27,8 +31,18 @@ void Screen::_two_second_error(const char* errstr)
   sleep(2);
 }
 
+Screen::backends Screen::backend=Screen::b_curses;
+
+//Pick how maps are drawn, for the Screens constructed after this
+void Screen::setBackend(backends b)
+{
+  backend=b;
+}
+
 //Screen ctor constructs a space with a box around it
 Screen::Screen(int h, int w)
+  : mapHeight(h), mapWidth(w), plots(0), bytes(0), shownValid(false), dialogUp(false),
+    inputGone(false), escState(0), toastShown(false)
 {
   //First, call initialization functions
   initscr();  // Start curses mode
@@ -62,6 +76,66 @@ Screen::Screen(int h, int w)
   box(outerWindow, 0, 0); //put frame around window (zeros mean use default chars)
   innerWindow=newwin(h, w, 1, 1); //note it's offset by one to miss the outer box
   panel=new_panel(innerWindow);
+
+  //toasts go under the map if there is room, else over its bottom rows
+  toastWidth=screenWidth<62 ? screenWidth : 62;
+  int toasty=h+2+toastLines+2<=screenHeight ? h+2 : screenHeight-toastLines-2;
+  toastY=toasty<0 ? 0 : toasty;
+  toastWindow=newwin(toastLines+2,toastWidth,toastY,0);
+  toastPanel=new_panel(toastWindow);
+  hide_panel(toastPanel);
+
+  if(backend==b_ansi)
+  {
+    cell blank={' ',A_NORMAL};
+    frame.assign(h*w,blank);
+    shown.assign(h*w,blank);
+  }
+}
+
+long Screen::_now_ms()
+{
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+  return ts.tv_sec*1000L+ts.tv_nsec/1000000L;
+}
+
+void Screen::_drawToasts()
+{
+  toastShown=!toasts.empty();
+  if(toastY<mapHeight+2)
+    shownValid=false; //the toasts cover part of the map, or just uncovered it
+  if(toasts.empty())
+    hide_panel(toastPanel);
+  else
+  {
+    werase(toastWindow);
+    box(toastWindow,0,0);
+    for(int i=0; i<toasts.size(); ++i)
+      mvwaddnstr(toastWindow,i+1,1,toasts[i].first.c_str(),toastWidth-2);
+    show_panel(toastPanel);
+  }
+  panelRefresh();
+}
+
+//Show a message without waiting for the player, it goes away on its own
+void Screen::toast(const char* msg)
+{
+  toasts.push_back(std::make_pair(std::string(msg),_now_ms()+toastMs));
+  if(toasts.size()>toastLines)
+    toasts.pop_front();
+  _drawToasts();
+}
+
+//Take down the toasts that have been up long enough
+void Screen::expireToasts()
+{
+  if(toasts.empty() || toasts.front().second>_now_ms())
+    return;
+  long now=_now_ms();
+  while(!toasts.empty() && toasts.front().second<=now)
+    toasts.pop_front();
+  _drawToasts();
 }
 
 void Screen::notice(const char* msg)
@@ -72,14 +146,23 @@ void Screen::notice(const char* msg)
   int xcoord=screenWidth>greater ? screenWidth/2-greater/2-1 : 0;
   WINDOW* dialog=newwin(4,greater+2,ycoord,xcoord);
   PANEL* dialog_panel=new_panel(dialog);
+  dialogUp=true;
     box(dialog,0,0);
   mvwprintw(dialog,1,1+(greater-strlen(msg))/2,msg);
   mvwprintw(dialog,2,1+(greater-strlen(dismiss))/2,dismiss);
   panelRefresh();
-  do;
-    while(getch()!=' ');
+  //ERR if stdin closed, nobody is there to press the spacebar
+  int delay=wgetdelay(stdscr);
+  int keystroke;
+  timeout(-1);
+  do
+    keystroke=getch();
+  while(keystroke!=' ' && keystroke!=ERR);
+  timeout(delay);
   del_panel(dialog_panel);
   delwin(dialog);
+  dialogUp=false;
+  shownValid=false;
   panelRefresh();
 
 }
@@ -96,6 +179,7 @@ int Screen::getOrdinal(const char* title, const std::vector<int>& nums)
   int xcoord= screenWidth/2-titlewidth/2;
   WINDOW* dialog=newwin(nums.size()+2,titlewidth,ycoord,xcoord);
   PANEL* dialog_panel=new_panel(dialog);
+  dialogUp=true;
   box(dialog,0,0);
   mvwprintw(dialog,0,titlewidth/2-strlen(title)/2,title);
   for(int i=1; i<nums.size()+1; ++i)
@@ -110,7 +194,7 @@ int Screen::getOrdinal(const char* title, const std::vector<int>& nums)
   do
   {
     keystroke=getch();
-    if(keystroke==KEY_BACKSPACE)
+    if(keystroke==KEY_BACKSPACE || keystroke==ERR)
       break;
     int i=0;
     for(int i=0; i<nums.size(); ++i)
@@ -122,8 +206,10 @@ int Screen::getOrdinal(const char* title, const std::vector<int>& nums)
   } while(!valid);
   del_panel(dialog_panel);
   delwin(dialog);
+  dialogUp=false;
+  shownValid=false;
   panelRefresh();
-  return (keystroke==KEY_BACKSPACE) ? 0 : keystroke-'0';
+  return (keystroke==KEY_BACKSPACE || keystroke==ERR) ? 0 : keystroke-'0';
 }
 
 std::string Screen::getText(void)
@@ -133,6 +219,7 @@ std::string Screen::getText(void)
   int xcoord=screenWidth>greater ? screenWidth/2-greater/2-1 : 0;
   WINDOW* dialog=newwin(3,greater+2,ycoord,xcoord);
   PANEL* dialog_panel=new_panel(dialog);
+  dialogUp=true;
   box(dialog,0,0);
   wmove(dialog,1,1);
   panelRefresh();
@@ -144,6 +231,8 @@ std::string Screen::getText(void)
   curs_set(0);
   del_panel(dialog_panel);
   delwin(dialog);
+  dialogUp=false;
+  shownValid=false;
   panelRefresh();
   return(std::string(str));
 }
@@ -156,8 +245,149 @@ Screen::~Screen()
 
 void Screen::panelRefresh()
 {
+  //ncurses writes the terminal itself, only the difference tells what it wrote
+  unsigned long before=_threadBytesSoFar();
   update_panels();
   doupdate();
+  bytes+=_threadBytesSoFar()-before;
+  if(backend==b_ansi)
+    _flushFrame();
+}
+
+namespace {
+  //the calling thread's own I/O counters, kept open for as long as the thread
+  struct threadIo {
+    int fd;
+    threadIo() : fd(open("/proc/thread-self/io",O_RDONLY|O_CLOEXEC)) {}
+    ~threadIo() { if(fd>=0) close(fd); }
+  };
+}
+
+//Bytes the calling thread has written so far, 0 if the kernel doesn't tell.
+//Only the thread's own writes count, not the log flusher's or anyone else's
+unsigned long Screen::_threadBytesSoFar()
+{
+  static thread_local threadIo io;
+  char buf[512];
+  if(io.fd<0)
+    return 0;
+  ssize_t n=pread(io.fd,buf,sizeof(buf)-1,0);
+  if(n<=0)
+    return 0;
+  buf[n]='\0';
+  const char* wchar=strstr(buf,"wchar:");
+  return wchar ? strtoul(wchar+6,NULL,10) : 0;
+}
+
+unsigned long Screen::getBytesWritten()
+{
+  return bytes;
+}
+
+//Is map cell y, x hidden under the toasts
+bool Screen::_underToast(int y, int x)
+{
+  return toastShown && y+1>=toastY && y+1<toastY+toastLines+2 && x+1<toastWidth;
+}
+
+//SGR sequence for a set of attributes, colors as ncurses sets them up
+void Screen::_appendSgr(std::string& out, unsigned int attr)
+{
+  short fg=COLOR_WHITE, bg=COLOR_BLACK;
+  if(PAIR_NUMBER(attr))
+    pair_content(PAIR_NUMBER(attr),&fg,&bg);
+  out+="\x1b[0";
+  if(attr & A_BOLD)
+    out+=";1";
+  if(attr & A_BLINK)
+    out+=";5";
+  if(attr & (A_STANDOUT|A_REVERSE))
+    out+=";7";
+  out+=";3"+std::to_string(fg)+";4"+std::to_string(bg)+"m";
+}
+
+//Write one cell, switching attributes and the line drawing charset only if
+//they differ from the previous cell's
+void Screen::_appendCell(std::string& out, const cell& c, unsigned int& attr, bool& acs)
+{
+  if(c.attr!=attr)
+  {
+    _appendSgr(out,c.attr);
+    attr=c.attr;
+  }
+  bool alt=(c.ch & A_ALTCHARSET)!=0;
+  if(alt!=acs)
+  {
+    out+=alt ? "\x1b(0" : "\x1b(B";
+    acs=alt;
+  }
+  out+=(char)(c.ch & A_CHARTEXT);
+}
+
+//b_ansi: send the map cells that changed since the last frame in a single
+//write(). Attributes are only sent when they change along the run, and the
+//cursor is only moved when the next changed cell isn't where the last write
+//left it (a short gap is cheaper to rewrite than to jump over). Afterwards the
+//terminal is left the way ncurses believes it is.
+void Screen::_flushFrame()
+{
+  if(dialogUp)
+    return;
+  std::string out;
+  unsigned int attr=A_NORMAL;
+  bool acs=false;
+  int cy=-1, cx=-1; //where the cursor is, in map coordinates
+  for(int y=0; y<mapHeight; ++y)
+  {
+    for(int x=0; x<mapWidth; ++x)
+    {
+      int i=y*mapWidth+x;
+      if((shownValid && frame[i]==shown[i]) || _underToast(y,x))
+        continue;
+      if(out.empty())
+        _appendSgr(out,A_NORMAL);
+      if(cy!=y || cx!=x)
+      {
+        bool rewrite=cy==y && x>cx && x-cx<=3;
+        for(int gx=cx; rewrite && gx<x; ++gx)
+          rewrite=!_underToast(y,gx);
+        if(rewrite)
+          for(int gx=cx; gx<x; ++gx)
+            _appendCell(out,frame[y*mapWidth+gx],attr,acs);
+        else if(cy==y && x>cx)
+          out+="\x1b["+std::to_string(x-cx)+"C";
+        else
+          out+="\x1b["+std::to_string(y+2)+";"+std::to_string(x+2)+"H";
+      }
+      _appendCell(out,frame[i],attr,acs);
+      shown[i]=frame[i];
+      cy=y;
+      cx=x+1;
+    }
+  }
+  shownValid=true;
+  if(out.empty())
+    return;
+
+  if(acs)
+    out+="\x1b(B";
+  if(attr!=A_NORMAL)
+    _appendSgr(out,A_NORMAL);
+  int ny, nx;
+  getyx(curscr,ny,nx);
+  out+="\x1b["+std::to_string(ny+1)+";"+std::to_string(nx+1)+"H";
+
+  const char* p=out.data();
+  size_t left=out.size();
+  while(left>0)
+  {
+    ssize_t n=write(STDOUT_FILENO,p,left);
+    if(n<0)
+      break;
+    p+=n;
+    left-=n;
+    bytes+=n;
+  }
 }
 
 std::pair<int,int> Screen::_getScreenSize()
@@ -169,15 +399,116 @@ std::pair<int,int> Screen::_getScreenSize()
 
 void Screen::plot(int y, int x, chtype ch, unsigned int attr)
 {
+  if(backend==b_ansi)
+  {
+    cell c={ch,attr};
+    frame[y*mapWidth+x]=c;
+    ++plots;
+    return;
+  }
   attr_t attr_save; //used in wattr_(get|set)
   short pair; //used in wattr_(get|set)
   wattr_get(innerWindow,&attr_save,&pair,NULL);//save terminal state
   wattron(innerWindow,attr); //Turn on any attributes passed in
   mvwaddch(innerWindow,y,x,ch); //Write out the character
   wattr_set(innerWindow,attr_save,pair,NULL);//restore terminal state
+  ++plots;
 }
 
 int Screen::getKey()
 {
   return getch();
 }
+
+//Make getKey() wait at most ms milliseconds (0 = don't wait, -1 = block)
+void Screen::setKeyTimeout(int ms)
+{
+  timeout(ms);
+}
+
+//Escape sequences, keypad keys such as the arrows, come as ESC [ or ESC O, then
+//parameters and a final byte. keypad() would turn them into KEY_UP and the like,
+//but readKeys() reads past ncurses, so they are dropped here instead, or their
+//last byte would read as a key ('A' for up, 'B' for down). Sequences may span
+//reads, so where we are in one is kept in escState.
+bool Screen::_inEscape(unsigned char c)
+{
+  enum { esc_none, esc_start, esc_csi, esc_ss3 };
+  switch(escState)
+  {
+    case esc_start:
+      if(c=='[')
+        escState=esc_csi;
+      else if(c=='O')
+        escState=esc_ss3;
+      else if(c!=27)
+      {
+        escState=esc_none; //a lone ESC, the byte is a key of its own
+        return false;
+      }
+      return true;
+    case esc_csi:
+      if(c>=0x40 && c<=0x7e) //final byte, parameters come before it
+        escState=esc_none;
+      return true;
+    case esc_ss3:
+      escState=esc_none;
+      return true;
+    default:
+      if(c==27)
+      {
+        escState=esc_start;
+        return true;
+      }
+      return false;
+  }
+}
+
+//Drain every key that is already pending with read(), without going through
+//ncurses, so it can be called while another thread draws. Escape sequences are
+//left out, see _inEscape()
+std::vector<int> Screen::readKeys()
+{
+  std::vector<int> keys;
+  unsigned char buf[64];
+  struct pollfd pfd={STDIN_FILENO,POLLIN,0};
+  while(poll(&pfd,1,0)>0)
+  {
+    if(!(pfd.revents & POLLIN))
+    {
+      inputGone=true; //hung up with nothing left to read
+      break;
+    }
+    ssize_t n=read(STDIN_FILENO,buf,sizeof(buf));
+    if(n<=0)
+    {
+      inputGone=inputGone || n==0; //end of file
+      break;
+    }
+    for(ssize_t i=0;i<n;++i)
+      if(!_inEscape(buf[i]))
+        keys.push_back(buf[i]);
+  }
+  return keys;
+}
+
+//Has stdin closed (e.g. the terminal went away), no key will ever come
+bool Screen::inputClosed()
+{
+  return inputGone;
+}
+
+unsigned long Screen::getPlotCount()
+{
+  return plots;
+}
+
+//Wait up to timeout_ms for a key press without consuming it. A hangup counts
+//too, so the caller reads the keys left and then finds inputClosed()
+bool Screen::waitForInput(int timeout_ms)
+{
+  struct pollfd pfd={STDIN_FILENO,POLLIN,0};
+  if(inputGone)
+    return true;
+  return poll(&pfd,1,timeout_ms)>0;
+}
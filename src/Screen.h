@@ -10,19 +10,57 @@
 #include<string>
 #include<stdexcept>
 #include<vector>
+#include<deque>
 #include"goldchase.h"
 
 /////
 // The Screen class provides a shallow interface to ncurses
 /////
 class Screen {
+  public:
+    enum backends {
+      b_curses = 0, //ncurses draws the map (default)
+      b_ansi        //the map is drawn from our own frame buffer, see _flushFrame()
+    };
   private:
+    struct cell {
+      chtype ch;
+      unsigned int attr;
+      bool operator==(const cell& o) const { return ch==o.ch && attr==o.attr; }
+    };
+    static backends backend;
     int screenHeight;
     int screenWidth;
+    int mapHeight;
+    int mapWidth;
     WINDOW* innerWindow;
     PANEL* panel;
+    unsigned long plots; //number of plot() calls so far
+    unsigned long bytes; //bytes written to the terminal so far
+    //b_ansi: the frame being plotted and the one on the terminal
+    std::vector<cell> frame;
+    std::vector<cell> shown;
+    bool shownValid; //false when something else drew over the map
+    bool dialogUp; //a dialog covers the map, don't draw it
+    bool inputGone; //stdin hung up, see inputClosed()
+    int escState; //readKeys(): where in an escape sequence the last read stopped
+    int toastY; //terminal row of the toast window
+    bool toastShown;
+    //toasts: made once, shown and hidden as messages come and go
+    WINDOW* toastWindow;
+    PANEL* toastPanel;
+    int toastWidth;
+    std::deque<std::pair<std::string,long> > toasts; //text, expiry in ms
     std::pair<int,int> _getScreenSize();
     void _two_second_error(const char* errstr);
+    void _drawToasts();
+    static long _now_ms();
+    static unsigned long _threadBytesSoFar();
+    bool _underToast(int y, int x);
+    bool _inEscape(unsigned char c);
+    void _flushFrame();
+    void _appendCell(std::string& out, const cell& c, unsigned int& attr, bool& acs);
+    static void _appendSgr(std::string& out, unsigned int attr);
 
   public:
     enum colorSchemes {
@@ -30,14 +68,25 @@ class Screen {
       c_error,
       c_overlap
     };
+    static const int toastLines=3; //most toasts shown at once
+    static const int toastMs=2500; //how long a toast stays up
+    static void setBackend(backends b);
     Screen(int h, int w);
     ~Screen();
     void panelRefresh();
     void plot(int y, int x, chtype ch, unsigned int attr=A_NORMAL);
     void notice(const char* msg);
+    void toast(const char* msg);
+    void expireToasts();
     std::string getText(void);
     int getOrdinal(const char* title, const std::vector<int>& nums);
     int getKey();
+    void setKeyTimeout(int ms);
+    bool waitForInput(int timeout_ms);
+    std::vector<int> readKeys();
+    bool inputClosed();
+    unsigned long getPlotCount();
+    unsigned long getBytesWritten();
 };
 
 
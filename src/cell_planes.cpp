@@ -0,0 +1,133 @@
+/**
+ * @file cell_planes.cpp
+ * @author Feras Alshehri (falshehri@mail.csuchico.edu)
+ * @brief wall, gold and occupancy planes of the game map.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <cstring>
+
+#include "cell_planes.h"
+
+/**
+ * @brief put gold on a cell.
+ *
+ * @param cell map cell index.
+ * @param kind G_GOLD or G_FOOL.
+ * @return false if the set is full (more than GOLD_SET_MAX gold) or the cell
+ * already held gold.
+ */
+bool Cell_planes::add_gold(unsigned int cell, unsigned char kind) {
+    if (gold_set->used >= GOLD_SET_MAX) { return false; }
+
+    for (unsigned int i = gold_hash(cell);; i = (i + 1) & (GOLD_SET_CAPACITY - 1)) {
+        gold_entry_S &e = gold_set->slots[i];
+        if (e.key == cell + 1) {
+            if (e.kind != 0) { return false; }
+            e.kind = kind; // gold back on a cell it was picked up from
+            gold_set->count++;
+            return true;
+        }
+        if (e.key == 0) {
+            e.kind = kind;
+            e.key  = cell + 1;
+            gold_set->count++;
+            gold_set->used++;
+            return true;
+        }
+    }
+}
+
+/**
+ * @brief pick up the gold on a cell.
+ *
+ * @param cell map cell index.
+ * @return unsigned char what was picked up, G_GOLD, G_FOOL or 0 if nothing.
+ */
+unsigned char Cell_planes::take_gold(unsigned int cell) {
+    for (unsigned int i = gold_hash(cell);; i = (i + 1) & (GOLD_SET_CAPACITY - 1)) {
+        gold_entry_S &e = gold_set->slots[i];
+        if (e.key == cell + 1) {
+            unsigned char kind = e.kind;
+            if (kind != 0) { gold_set->count--; }
+            e.kind = 0;
+            return kind;
+        }
+        if (e.key == 0) { return 0; }
+    }
+}
+
+/**
+ * @brief gold of one kind still lying on the map.
+ *
+ * @param kind G_GOLD or G_FOOL.
+ */
+unsigned int Cell_planes::count_gold(unsigned char kind) const {
+    unsigned int n = 0;
+    for (const gold_entry_S &e : gold_set->slots) { n += (e.kind == kind); }
+    return n;
+}
+
+/**
+ * @brief drop the slots of picked up gold, which are otherwise kept for good, to
+ *          make room for gold put back on new cells. Readers not holding the
+ *          semaphore may miss a piece while the set is rebuilt.
+ */
+void Cell_planes::compact_gold() {
+    std::vector<gold_entry_S> live;
+    for (const gold_entry_S &e : gold_set->slots) {
+        if (e.kind != 0) { live.push_back(e); }
+    }
+    std::memset(gold_set, 0, sizeof(gold_set_S));
+    for (const gold_entry_S &e : live) { add_gold(e.key - 1, e.kind); }
+}
+
+/**
+ * @brief empty every plane.
+ */
+void Cell_planes::clear() {
+    std::memset(walls, 0, cell_planes_wall_words(rows, cols) * sizeof(uint64_t));
+    std::memset(occupancy, 0, (size_t)rows * cols);
+    std::memset(gold_set, 0, sizeof(gold_set_S));
+}
+
+/**
+ * @brief write the whole map in the single byte per cell encoding.
+ *
+ * @param out rows * cols bytes.
+ */
+void Cell_planes::compose(unsigned char *out) const {
+    for (unsigned int i = 0; i < rows * cols; ++i) {
+        out[i] = is_wall(i) ? G_WALL : occupancy[i];
+    }
+    for (const gold_entry_S &e : gold_set->slots) {
+        if (e.kind != 0) { out[e.key - 1] = e.kind; }
+    }
+}
+
+/**
+ * @brief copy the planes that change during a game, occupancy and gold, from a map
+ *          of the same size. The walls are left alone, they were copied once.
+ *
+ * @param from map to copy.
+ */
+void Cell_planes::copy_changing(const Cell_planes &from) {
+    std::memcpy(occupancy, from.occupancy, (size_t)rows * cols);
+    std::memcpy(gold_set, from.gold_set, sizeof(gold_set_S));
+}
+
+/**
+ * @brief number of 64 bit words in the wall bitset of a rows x cols map.
+ */
+size_t cell_planes_wall_words(unsigned int rows, unsigned int cols) {
+    return ((size_t)rows * cols + 63) / 64;
+}
+
+Cell_planes_buffer::Cell_planes_buffer(unsigned int rows, unsigned int cols)
+    : walls(cell_planes_wall_words(rows, cols)), occupancy((size_t)rows * cols),
+      gold(new gold_set_S()),
+      view(walls.data(), occupancy.data(), gold.get(), rows, cols) {}
@@ -0,0 +1,115 @@
+#ifndef __CELL_PLANES_H__
+#define __CELL_PLANES_H__
+
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+#include "goldchase.h"
+
+#define GOLD_SET_CAPACITY 1024                 // hash slots, a power of two
+#define GOLD_SET_MAX (GOLD_SET_CAPACITY / 2)   // most gold a map may hold
+
+struct gold_entry_S {
+    uint32_t key;  // cell + 1, 0 = slot never used
+    uint8_t  kind; // G_GOLD or G_FOOL, 0 once picked up
+    uint8_t  reserved[3];
+};
+
+// open addressing hash of the gold cells. Picked up gold keeps its slot (kind 0),
+// so probing never has to deal with deletions.
+struct gold_set_S {
+    uint32_t     count; // gold still on the map
+    uint32_t     used;  // slots ever filled
+    gold_entry_S slots[GOLD_SET_CAPACITY];
+};
+
+/**
+ * @brief view of the map split by how often each part changes: a wall bitset that
+ *          is written once and then only read, a sparse set of the gold, and one
+ *          occupancy byte per cell holding nothing but player bits. Moves only
+ *          write the occupancy plane, so they never dirty the cache lines the wall
+ *          checks and renderers read.
+ *
+ *        Does not own any of the planes, see goldmine_planes() and
+ *        Cell_planes_buffer.
+ */
+class Cell_planes {
+  private:
+    uint64_t      *walls     = nullptr;
+    unsigned char *occupancy = nullptr;
+    gold_set_S    *gold_set  = nullptr;
+    unsigned int   rows      = 0;
+    unsigned int   cols      = 0;
+
+    static unsigned int gold_hash(unsigned int cell) {
+        return (cell * 2654435761u) & (GOLD_SET_CAPACITY - 1);
+    }
+
+  public:
+    Cell_planes() {}
+    Cell_planes(uint64_t *walls, unsigned char *occupancy, gold_set_S *gold,
+                unsigned int rows, unsigned int cols)
+        : walls(walls), occupancy(occupancy), gold_set(gold), rows(rows), cols(cols) {}
+
+    unsigned int get_rows() const { return rows; }
+    unsigned int get_cols() const { return cols; }
+    unsigned int get_cells() const { return rows * cols; }
+
+    bool is_wall(unsigned int cell) const { return (walls[cell >> 6] >> (cell & 63)) & 1; }
+    void set_wall(unsigned int cell) { walls[cell >> 6] |= 1ull << (cell & 63); }
+
+    unsigned char players(unsigned int cell) const { return occupancy[cell]; }
+    const unsigned char *get_players() const { return occupancy; } // for cell_scan.h
+    void set_players(unsigned int cell, unsigned char mask) { occupancy[cell] = mask; }
+
+    /**
+     * @brief G_GOLD or G_FOOL if that gold is still lying on the cell, else 0.
+     */
+    unsigned char gold(unsigned int cell) const {
+        for (unsigned int i = gold_hash(cell);; i = (i + 1) & (GOLD_SET_CAPACITY - 1)) {
+            const gold_entry_S &e = gold_set->slots[i];
+            if (e.key == cell + 1) { return e.kind; }
+            if (e.key == 0) { return 0; }
+        }
+    }
+    const gold_set_S &get_gold_set() const { return *gold_set; }
+
+    /**
+     * @brief the cell as the single byte encoding of goldchase.h (what the map used
+     *          to store), for the journal and other code that wants one value.
+     */
+    unsigned char cell_value(unsigned int cell) const {
+        if (is_wall(cell)) { return G_WALL; }
+        if (occupancy[cell]) { return occupancy[cell]; }
+        return gold(cell);
+    }
+
+    bool          add_gold(unsigned int cell, unsigned char kind);
+    unsigned char take_gold(unsigned int cell);
+    unsigned int  count_gold(unsigned char kind) const;
+    void          compact_gold();
+    void          clear();
+    void          compose(unsigned char *out) const;
+    void          copy_changing(const Cell_planes &from);
+};
+
+size_t cell_planes_wall_words(unsigned int rows, unsigned int cols);
+
+/**
+ * @brief planes in private memory, for code working on a map outside the game
+ *          segment (tools, benchmarks).
+ */
+class Cell_planes_buffer {
+  private:
+    std::vector<uint64_t>       walls;
+    std::vector<unsigned char>  occupancy;
+    std::unique_ptr<gold_set_S> gold;
+    Cell_planes                 view;
+
+  public:
+    Cell_planes_buffer(unsigned int rows, unsigned int cols);
+    Cell_planes &planes() { return view; }
+};
+
+#endif // __CELL_PLANES_H__
@@ -0,0 +1,286 @@
+/**
+ * @file cell_scan.cpp
+ * @author Feras Alshehri (falshehri@mail.csuchico.edu)
+ * @brief byte per cell scans (finding a player, skipping empty cells, diffing
+ *          frames) 16 or 32 cells at a time with SSE2 or AVX2, with a scalar
+ *          fallback. The kernels are picked once at runtime from what the CPU
+ *          supports, so the binaries need no -mavx2.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <cstdlib>
+#include <cstring>
+
+#include "cell_scan.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CELL_SCAN_X86
+#endif
+
+struct cell_scan_kernels_S {
+    size_t (*find_equal)(const unsigned char *, size_t, unsigned char);
+    size_t (*find_any)(const unsigned char *, size_t, unsigned char);
+    size_t (*count_equal)(const unsigned char *, size_t, unsigned char);
+    size_t (*diff)(const unsigned char *, const unsigned char *, size_t, uint32_t *);
+};
+
+/*
+ * scalar, also the tail of the vector kernels
+ */
+
+static size_t find_equal_scalar(const unsigned char *cells, size_t count, unsigned char value) {
+    for (size_t i = 0; i < count; ++i) {
+        if (cells[i] == value) { return i; }
+    }
+    return count;
+}
+
+static size_t find_any_scalar(const unsigned char *cells, size_t count, unsigned char mask) {
+    for (size_t i = 0; i < count; ++i) {
+        if (cells[i] & mask) { return i; }
+    }
+    return count;
+}
+
+static size_t count_equal_scalar(const unsigned char *cells, size_t count, unsigned char value) {
+    size_t n = 0;
+    for (size_t i = 0; i < count; ++i) { n += (cells[i] == value); }
+    return n;
+}
+
+static size_t diff_scalar(const unsigned char *a, const unsigned char *b, size_t count,
+                          uint32_t *dirty) {
+    size_t n = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (a[i] != b[i]) { dirty[n++] = i; }
+    }
+    return n;
+}
+
+static const cell_scan_kernels_S scalar_kernels = {find_equal_scalar, find_any_scalar,
+                                                   count_equal_scalar, diff_scalar};
+
+#ifdef CELL_SCAN_X86
+
+/*
+ * SSE2, which every x86-64 CPU has. A compare gives 0xff per matching byte and
+ * movemask packs those into one bit per cell, so a block of 16 cells is
+ * skipped with one test.
+ */
+
+static size_t find_equal_sse2(const unsigned char *cells, size_t count, unsigned char value) {
+    const __m128i v = _mm_set1_epi8((char)value);
+    size_t        i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i  c    = _mm_loadu_si128((const __m128i *)(cells + i));
+        unsigned bits = _mm_movemask_epi8(_mm_cmpeq_epi8(c, v));
+        if (bits) { return i + __builtin_ctz(bits); }
+    }
+    return i + find_equal_scalar(cells + i, count - i, value);
+}
+
+static size_t find_any_sse2(const unsigned char *cells, size_t count, unsigned char mask) {
+    const __m128i m    = _mm_set1_epi8((char)mask);
+    const __m128i zero = _mm_setzero_si128();
+    size_t        i    = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i  c    = _mm_and_si128(_mm_loadu_si128((const __m128i *)(cells + i)), m);
+        unsigned bits = _mm_movemask_epi8(_mm_cmpeq_epi8(c, zero)) ^ 0xffffu;
+        if (bits) { return i + __builtin_ctz(bits); }
+    }
+    return i + find_any_scalar(cells + i, count - i, mask);
+}
+
+static size_t count_equal_sse2(const unsigned char *cells, size_t count, unsigned char value) {
+    const __m128i v = _mm_set1_epi8((char)value);
+    size_t        n = 0, i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i c = _mm_loadu_si128((const __m128i *)(cells + i));
+        n += __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(c, v)));
+    }
+    return n + count_equal_scalar(cells + i, count - i, value);
+}
+
+static size_t diff_sse2(const unsigned char *a, const unsigned char *b, size_t count,
+                        uint32_t *dirty) {
+    size_t n = 0, i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i  ca   = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i  cb   = _mm_loadu_si128((const __m128i *)(b + i));
+        unsigned bits = _mm_movemask_epi8(_mm_cmpeq_epi8(ca, cb)) ^ 0xffffu;
+        for (; bits; bits &= bits - 1) { dirty[n++] = i + __builtin_ctz(bits); }
+    }
+    for (; i < count; ++i) {
+        if (a[i] != b[i]) { dirty[n++] = i; }
+    }
+    return n;
+}
+
+static const cell_scan_kernels_S sse2_kernels = {find_equal_sse2, find_any_sse2,
+                                                 count_equal_sse2, diff_sse2};
+
+/*
+ * AVX2, 32 cells a step. Compiled for AVX2 function by function, and only ever
+ * called once the CPU was found to have it.
+ */
+
+#define AVX2 __attribute__((target("avx2")))
+
+AVX2 static size_t find_equal_avx2(const unsigned char *cells, size_t count,
+                                   unsigned char value) {
+    const __m256i v = _mm256_set1_epi8((char)value);
+    size_t        i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i  c    = _mm256_loadu_si256((const __m256i *)(cells + i));
+        unsigned bits = _mm256_movemask_epi8(_mm256_cmpeq_epi8(c, v));
+        if (bits) { return i + __builtin_ctz(bits); }
+    }
+    return i + find_equal_sse2(cells + i, count - i, value);
+}
+
+AVX2 static size_t find_any_avx2(const unsigned char *cells, size_t count, unsigned char mask) {
+    const __m256i m    = _mm256_set1_epi8((char)mask);
+    const __m256i zero = _mm256_setzero_si256();
+    size_t        i    = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i  c    = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(cells + i)), m);
+        unsigned bits = ~(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(c, zero));
+        if (bits) { return i + __builtin_ctz(bits); }
+    }
+    return i + find_any_sse2(cells + i, count - i, mask);
+}
+
+AVX2 static size_t count_equal_avx2(const unsigned char *cells, size_t count,
+                                    unsigned char value) {
+    const __m256i v = _mm256_set1_epi8((char)value);
+    size_t        n = 0, i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i c = _mm256_loadu_si256((const __m256i *)(cells + i));
+        n += __builtin_popcount(_mm256_movemask_epi8(_mm256_cmpeq_epi8(c, v)));
+    }
+    return n + count_equal_sse2(cells + i, count - i, value);
+}
+
+AVX2 static size_t diff_avx2(const unsigned char *a, const unsigned char *b, size_t count,
+                             uint32_t *dirty) {
+    size_t n = 0, i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i  ca   = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i  cb   = _mm256_loadu_si256((const __m256i *)(b + i));
+        unsigned bits = ~(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(ca, cb));
+        for (; bits; bits &= bits - 1) { dirty[n++] = i + __builtin_ctz(bits); }
+    }
+    size_t tail = diff_sse2(a + i, b + i, count - i, dirty + n);
+    for (size_t k = n; k < n + tail; ++k) { dirty[k] += i; }
+    return n + tail;
+}
+
+static const cell_scan_kernels_S avx2_kernels = {find_equal_avx2, find_any_avx2,
+                                                 count_equal_avx2, diff_avx2};
+
+#endif // CELL_SCAN_X86
+
+/**
+ * @brief the widest kernels this CPU runs.
+ */
+CELL_SCAN_LEVEL_E cell_scan_best_level() {
+#ifdef CELL_SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) { return scan_avx2; }
+    if (__builtin_cpu_supports("sse2")) { return scan_sse2; }
+#endif
+    return scan_scalar;
+}
+
+static const cell_scan_kernels_S *kernels_of(CELL_SCAN_LEVEL_E level) {
+#ifdef CELL_SCAN_X86
+    if (level == scan_avx2) { return &avx2_kernels; }
+    if (level == scan_sse2) { return &sse2_kernels; }
+#endif
+    return &scalar_kernels;
+}
+
+/**
+ * @brief the level to start with: the best one, unless CELL_SCAN_ENV asks for a
+ *          narrower one.
+ */
+static CELL_SCAN_LEVEL_E initial_level() {
+    CELL_SCAN_LEVEL_E best = cell_scan_best_level();
+    const char       *want = getenv(CELL_SCAN_ENV);
+    for (int level = scan_scalar; want && (level <= best); ++level) {
+        if (strcmp(want, cell_scan_level_name((CELL_SCAN_LEVEL_E)level)) == 0) {
+            return (CELL_SCAN_LEVEL_E)level;
+        }
+    }
+    return best;
+}
+
+static CELL_SCAN_LEVEL_E          active_level = initial_level();
+static const cell_scan_kernels_S *active       = kernels_of(active_level);
+
+CELL_SCAN_LEVEL_E cell_scan_get_level() { return active_level; }
+
+/**
+ * @brief use other kernels from now on, e.g. to compare them.
+ *
+ * @return false if the CPU can't run them, the kernels are left as they were.
+ */
+bool cell_scan_set_level(CELL_SCAN_LEVEL_E level) {
+    if (level > cell_scan_best_level()) { return false; }
+    active_level = level;
+    active       = kernels_of(level);
+    return true;
+}
+
+const char *cell_scan_level_name(CELL_SCAN_LEVEL_E level) {
+    switch (level) {
+    case scan_avx2:
+        return "avx2";
+    case scan_sse2:
+        return "sse2";
+    default:
+        return "scalar";
+    }
+}
+
+/**
+ * @brief first cell holding exactly value, e.g. a player's own bit.
+ *
+ * @return size_t its index, count if there is none.
+ */
+size_t cell_find_equal(const unsigned char *cells, size_t count, unsigned char value) {
+    return active->find_equal(cells, count, value);
+}
+
+/**
+ * @brief first cell with any of the bits of mask set.
+ *
+ * @return size_t its index, count if there is none.
+ */
+size_t cell_find_any(const unsigned char *cells, size_t count, unsigned char mask) {
+    return active->find_any(cells, count, mask);
+}
+
+/**
+ * @brief number of cells holding exactly value.
+ */
+size_t cell_count_equal(const unsigned char *cells, size_t count, unsigned char value) {
+    return active->count_equal(cells, count, value);
+}
+
+/**
+ * @brief the cells that differ between two planes.
+ *
+ * @param dirty out, indices of the cells that differ in increasing order; room
+ * for count of them.
+ * @return size_t number of cells that differ.
+ */
+size_t cell_diff(const unsigned char *a, const unsigned char *b, size_t count,
+                 uint32_t *dirty) {
+    return active->diff(a, b, count, dirty);
+}
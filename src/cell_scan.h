@@ -0,0 +1,24 @@
+#ifndef __CELL_SCAN_H__
+#define __CELL_SCAN_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CELL_SCAN_ENV "GOLDCHASE_SIMD" // "scalar", "sse2" or "avx2" overrides the pick
+
+enum CELL_SCAN_LEVEL_E { scan_scalar, scan_sse2, scan_avx2 };
+
+CELL_SCAN_LEVEL_E cell_scan_best_level();
+CELL_SCAN_LEVEL_E cell_scan_get_level();
+bool              cell_scan_set_level(CELL_SCAN_LEVEL_E level);
+const char       *cell_scan_level_name(CELL_SCAN_LEVEL_E level);
+
+// scans over one byte per cell planes (occupancy), with the widest vector
+// instructions the CPU has; see cell_scan.cpp
+size_t cell_find_equal(const unsigned char *cells, size_t count, unsigned char value);
+size_t cell_find_any(const unsigned char *cells, size_t count, unsigned char mask);
+size_t cell_count_equal(const unsigned char *cells, size_t count, unsigned char value);
+size_t cell_diff(const unsigned char *a, const unsigned char *b, size_t count,
+                 uint32_t *dirty);
+
+#endif // __CELL_SCAN_H__
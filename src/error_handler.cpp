@@ -8,71 +8,81 @@
  * @copyright Copyright (c) 2022
  *
  */
-#include <iostream>
-#include <stdio.h> // for perror
-
 #include "error_handler.h"
+#include "game_log.h"
 
 /**
- * @brief prints a specific message to the user corresponding to the
- *          error_code given, invokes any necessary cleaning routines,
- *          and returns.
+ * @brief logs a specific message corresponding to the error_code given, with
+ *          what errno says where a system call failed, and returns. The
+ *          message goes to stderr, or to the log file while the game runs,
+ *          see game_log.h.
  *
  * @param error_code see error_code enum in error_handler.h
  */
 void handle_error(ERROR_CODE_E error_code) {
-    // @TODO convert cout to perror() calls ...
     switch (error_code) {
     case ok:
-        perror("Success!");
+        LOG_INFO("Success!");
         break;
     case error_map_file_specified_by_subsequent_player:
-        perror("ERROR: subsequent player specified a map file");
+        LOG_ERRNO("ERROR: subsequent player specified a map file");
         break;
     case error_no_map_file_specified_by_first_player:
-        perror("ERROR: no map file is given by first player");
+        LOG_ERRNO("ERROR: no map file is given by first player");
         break;
     case error_map_file_specified_is_not_valid:
-        perror("ERROR: map file specified is not valid");
+        LOG_ERRNO("ERROR: map file specified is not valid");
         break;
     case error_map_constructor_threw_an_exception:
-        printf("ERROR: constructor of map class threw and exception");
+        LOG_ERROR("ERROR: constructor of map class threw and exception");
         break;
     case error_in_shm_open:
-        perror("ERROR: error in shem_open()");
+        LOG_ERRNO("ERROR: error in shem_open()");
         break;
     case error_in_shm_unlink:
-        perror("ERROR: error in shem_unlink()");
+        LOG_ERRNO("ERROR: error in shem_unlink()");
         break;
     case error_in_sem_unlink:
-        perror("ERROR: error in sem_unlink()");
+        LOG_ERRNO("ERROR: error in sem_unlink()");
         break;
     case error_in_sem_close:
-        perror("ERROR: error in sem_close()");
+        LOG_ERRNO("ERROR: error in sem_close()");
         break;
     case error_in_sem_wait:
-        perror("ERROR: error in sem_wait()");
+        LOG_ERRNO("ERROR: error in sem_wait()");
         break;
     case error_in_sem_post:
-        perror("ERROR: error in sem_post()");
+        LOG_ERRNO("ERROR: error in sem_post()");
         break;
     case error_failed_initialization:
-        perror("ERROR: initialization failed");
+        LOG_ERRNO("ERROR: initialization failed");
         break;
     case error_failed_map_rendering:
-        perror("ERROR: failed to render map");
+        LOG_ERRNO("ERROR: failed to render map");
         break;
     case error_in_ftruncate:
-        perror("ERROR: error in ftruncate()");
+        LOG_ERRNO("ERROR: error in ftruncate()");
         break;
     case error_in_mmap:
-        perror("ERROR: error in mmap()");
+        LOG_ERRNO("ERROR: error in mmap()");
         break;
     case error_illegal_charecter_in_map_file:
-        perror("ERROR: detected an illegal charecter in map file (num gold, then only space, newline, and asterisk are legal)");
+        LOG_ERRNO("ERROR: detected an illegal charecter in map file (num gold, then only space, newline, and asterisk are legal)");
+        break;
+    case error_map_gold_not_reachable:
+        LOG_ERROR("ERROR: map has no open area touching the edge large enough for gold and players");
+        break;
+    case error_snapshot_not_valid:
+        LOG_ERRNO("ERROR: snapshot file specified is not valid");
+        break;
+    case error_map_too_much_gold:
+        LOG_ERROR("ERROR: map has more gold than the game can track");
+        break;
+    case error_shm_arena_full:
+        LOG_ERROR("ERROR: no room left in the shared segment's arena");
         break;
     case error_max_number_of_players_reached:
-        printf("ERROR: maximum number of players reached! (max=5)");
+        LOG_ERROR("ERROR: maximum number of players reached! (max=5)");
         break;
     }
 }
\ No newline at end of file
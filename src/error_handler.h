@@ -19,6 +19,10 @@ enum ERROR_CODE_E {
     error_in_sem_post,
     error_failed_initialization,
     error_failed_map_rendering,
+    error_map_gold_not_reachable,
+    error_snapshot_not_valid,
+    error_map_too_much_gold,
+    error_shm_arena_full,
     error_,
     count_of_error_codes
 };
@@ -0,0 +1,120 @@
+/**
+ * @file event_loop.cpp
+ * @author Feras Alshehri (falshehri@mail.csuchico.edu)
+ * @brief epoll driven scheduler of coroutine player sessions.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <errno.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include "event_loop.h"
+
+Event_loop::Event_loop() : epoll_fd(epoll_create1(EPOLL_CLOEXEC)) {}
+
+/**
+ * @brief Destroy the Event_loop object, and whatever tasks never finished.
+ */
+Event_loop::~Event_loop() {
+    for (std::coroutine_handle<> h : ready) { h.destroy(); }
+    for (const lock_waiter_S &w : lock_waiters) { w.handle.destroy(); }
+    for (const change_waiter_S &w : change_waiters) { w.handle.destroy(); }
+    if (epoll_fd >= 0) { close(epoll_fd); }
+}
+
+/**
+ * @brief hand a task to the loop. It first runs from run().
+ *
+ * @param task task to run, the loop owns it from now on.
+ */
+void Event_loop::spawn(Session_task &&task) {
+    ready.push_back(task.release());
+    ++live;
+}
+
+/**
+ * @brief resume handle once fd is readable. The fd is armed one shot, so a task
+ *          that stops reading from it is never woken for it again.
+ *
+ * @param fd file descriptor.
+ * @param handle suspended task.
+ */
+void Event_loop::wait_fd(int fd, std::coroutine_handle<> handle) {
+    struct epoll_event ev;
+    ev.events   = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    ev.data.ptr = handle.address();
+    if ((epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev) != 0) &&
+        ((errno != ENOENT) || (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0))) {
+        // not pollable, let the task find out from its read()
+        ready.push_back(handle);
+    }
+}
+
+/**
+ * @brief move the tasks whose semaphore could be taken, or whose generation moved
+ *          on, to the ready queue.
+ */
+void Event_loop::poll_waiters() {
+    size_t kept = 0;
+    for (size_t i = 0; i < lock_waiters.size(); ++i) {
+        if (sem_trywait(lock_waiters[i].semaphore) == 0) {
+            ready.push_back(lock_waiters[i].handle);
+            lock_spins = 0;
+        } else {
+            lock_waiters[kept++] = lock_waiters[i];
+        }
+    }
+    lock_waiters.resize(kept);
+
+    kept = 0;
+    for (size_t i = 0; i < change_waiters.size(); ++i) {
+        const change_waiter_S &w = change_waiters[i];
+        if (__atomic_load_n(w.generation, __ATOMIC_ACQUIRE) != w.seen) {
+            ready.push_back(w.handle);
+        } else {
+            change_waiters[kept++] = w;
+        }
+    }
+    change_waiters.resize(kept);
+}
+
+/**
+ * @brief run the spawned tasks until every one of them has finished.
+ */
+void Event_loop::run() {
+    struct epoll_event events[EVENT_LOOP_MAX_EVENTS];
+
+    while (live > 0) {
+        while (!ready.empty()) {
+            std::coroutine_handle<> h = ready.front();
+            ready.pop_front();
+            h.resume();
+            if (h.done()) {
+                h.destroy();
+                --live;
+            }
+        }
+
+        poll_waiters();
+        if (!ready.empty() || (live == 0)) { continue; }
+
+        // a task waiting for the semaphore spins through here for a few rounds, as
+        // players always did, then backs off to short sleeps; either way the
+        // others keep being served
+        int timeout = -1;
+        if (!lock_waiters.empty()) {
+            timeout = (lock_spins++ < EVENT_LOOP_LOCK_SPINS) ? 0 : EVENT_LOOP_LOCK_BACKOFF_MS;
+        } else if (!change_waiters.empty()) {
+            timeout = EVENT_LOOP_POLL_MS;
+        }
+        int n = epoll_wait(epoll_fd, events, EVENT_LOOP_MAX_EVENTS, timeout);
+        for (int i = 0; i < n; ++i) {
+            ready.push_back(std::coroutine_handle<>::from_address(events[i].data.ptr));
+        }
+    }
+}
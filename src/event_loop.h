@@ -0,0 +1,134 @@
+#ifndef __EVENT_LOOP_H__
+#define __EVENT_LOOP_H__
+
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <semaphore.h>
+#include <vector>
+
+#define EVENT_LOOP_MAX_EVENTS 256    // epoll events taken per wait
+#define EVENT_LOOP_POLL_MS 5         // map changes by other processes are noticed this often
+#define EVENT_LOOP_LOCK_SPINS 16     // rounds a semaphore is retried back to back
+#define EVENT_LOOP_LOCK_BACKOFF_MS 1 // then how long the loop sleeps between retries
+
+/**
+ * @brief coroutine run by an Event_loop. It starts suspended and only runs once
+ *          handed to Event_loop::spawn(), which then owns it.
+ */
+class Session_task {
+  public:
+    struct promise_type {
+        Session_task get_return_object() {
+            return Session_task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void                return_void() {}
+        void                unhandled_exception() { std::terminate(); }
+    };
+
+    explicit Session_task(std::coroutine_handle<promise_type> h) : handle(h) {}
+    Session_task(Session_task &&other) : handle(other.handle) { other.handle = nullptr; }
+    Session_task(const Session_task &)            = delete;
+    Session_task &operator=(const Session_task &) = delete;
+    ~Session_task() {
+        if (handle) { handle.destroy(); }
+    }
+
+    std::coroutine_handle<> release() {
+        std::coroutine_handle<> h = handle;
+        handle                    = nullptr;
+        return h;
+    }
+
+  private:
+    std::coroutine_handle<promise_type> handle;
+};
+
+/**
+ * @brief single threaded scheduler of Session_tasks. A task suspends on one of the
+ *          awaitables below instead of blocking the thread, so one thread can run
+ *          as many player sessions as it has CPU for:
+ *
+ *            co_await loop.readable(fd)           keys (or anything) to read on fd
+ *            co_await loop.lock(semaphore)        the game semaphore is ours
+ *            co_await loop.changed(&gen, seen)    the map generation moved on
+ *
+ *        Readiness of file descriptors comes from epoll. A semaphore or a counter
+ *        in shared memory can't be waited for with epoll, so tasks waiting on
+ *        those are retried every time around the loop. The loop wakes up at least
+ *        every EVENT_LOOP_POLL_MS while any wait for a change, and while one waits
+ *        for the semaphore it spins for EVENT_LOOP_LOCK_SPINS rounds, then retries
+ *        every EVENT_LOOP_LOCK_BACKOFF_MS so a long held semaphore doesn't keep
+ *        the thread busy.
+ */
+class Event_loop {
+  private:
+    struct lock_waiter_S {
+        sem_t                  *semaphore;
+        std::coroutine_handle<> handle;
+    };
+    struct change_waiter_S {
+        const unsigned int     *generation;
+        unsigned int            seen;
+        std::coroutine_handle<> handle;
+    };
+
+    int                                 epoll_fd;
+    unsigned int                        live       = 0; // tasks spawned and not finished
+    unsigned int                        lock_spins = 0; // rounds no lock waiter got in
+    std::deque<std::coroutine_handle<>> ready;
+    std::vector<lock_waiter_S>          lock_waiters;
+    std::vector<change_waiter_S>        change_waiters;
+
+    void wait_fd(int fd, std::coroutine_handle<> handle);
+    void poll_waiters();
+
+  public:
+    struct readable_awaiter {
+        Event_loop &loop;
+        int         fd;
+        bool        await_ready() const noexcept { return false; }
+        void        await_suspend(std::coroutine_handle<> h) { loop.wait_fd(fd, h); }
+        void        await_resume() const noexcept {}
+    };
+    struct lock_awaiter {
+        Event_loop &loop;
+        sem_t      *semaphore;
+        bool        await_ready() const noexcept { return sem_trywait(semaphore) == 0; }
+        void        await_suspend(std::coroutine_handle<> h) {
+            loop.lock_waiters.push_back({semaphore, h});
+        }
+        void await_resume() const noexcept {}
+    };
+    struct change_awaiter {
+        Event_loop         &loop;
+        const unsigned int *generation;
+        unsigned int        seen;
+        bool                await_ready() const noexcept {
+            return __atomic_load_n(generation, __ATOMIC_ACQUIRE) != seen;
+        }
+        void await_suspend(std::coroutine_handle<> h) {
+            loop.change_waiters.push_back({generation, seen, h});
+        }
+        unsigned int await_resume() const noexcept {
+            return __atomic_load_n(generation, __ATOMIC_ACQUIRE);
+        }
+    };
+
+    Event_loop();
+    ~Event_loop();
+
+    bool is_good() const { return epoll_fd >= 0; }
+    void spawn(Session_task &&task);
+    void run();
+
+    readable_awaiter readable(int fd) { return {*this, fd}; }
+    lock_awaiter     lock(sem_t *semaphore) { return {*this, semaphore}; }
+    change_awaiter   changed(const unsigned int *generation, unsigned int seen) {
+        return {*this, generation, seen};
+    }
+};
+
+#endif // __EVENT_LOOP_H__
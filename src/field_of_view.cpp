@@ -0,0 +1,140 @@
+/**
+ * @file field_of_view.cpp
+ * @author Feras Alshehri (falshehri@mail.csuchico.edu)
+ * @brief line of sight for the fog of war, recursive shadowcasting over the walls.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <algorithm>
+
+#include "field_of_view.h"
+
+/**
+ * @brief Construct a new Field_of_view object.
+ *
+ * @param planes map planes, only the walls are read.
+ * @param radius how far a player sees, 0 for no limit. No one sees further than
+ * across the map, so that is the limit.
+ */
+Field_of_view::Field_of_view(const Cell_planes &planes, unsigned int radius)
+    : planes(planes), lit((planes.get_cells() + 63) / 64, 0) {
+    unsigned int across = planes.get_rows() + planes.get_cols();
+    this->radius        = radius ? std::min(radius, across) : across;
+}
+
+/**
+ * @brief sight stops at walls and at the map edge.
+ */
+bool Field_of_view::blocks(int row, int col) const {
+    if ((row < 0) || (col < 0) || (row >= (int)planes.get_rows()) ||
+        (col >= (int)planes.get_cols())) {
+        return true;
+    }
+    return planes.is_wall(row * planes.get_cols() + col);
+}
+
+/**
+ * @brief add a cell to the visible set, once.
+ */
+void Field_of_view::light(int row, int col, std::vector<unsigned int> &visible) {
+    if ((row < 0) || (col < 0) || (row >= (int)planes.get_rows()) ||
+        (col >= (int)planes.get_cols())) {
+        return;
+    }
+    unsigned int cell = row * planes.get_cols() + col;
+    uint64_t     bit  = 1ull << (cell & 63);
+    if (!(lit[cell >> 6] & bit)) {
+        lit[cell >> 6] |= bit;
+        visible.push_back(cell);
+    }
+}
+
+/**
+ * @brief scan one octant outward from distance, between the start and end slopes.
+ *          A wall narrows the lit span and the part beside it is scanned by a
+ *          recursive call, so every cell is looked at no more than once per octant.
+ *
+ * @param row viewer row.
+ * @param col viewer col.
+ * @param distance first distance to scan.
+ * @param start slope where the lit span starts.
+ * @param end slope where the lit span ends.
+ * @param xx,xy,yx,yy transform from octant coordinates to map coordinates.
+ * @param visible lit cells are appended here.
+ */
+void Field_of_view::cast_light(int row, int col, int distance, double start, double end,
+                               int xx, int xy, int yx, int yy,
+                               std::vector<unsigned int> &visible) {
+    if (start < end) { return; }
+
+    int64_t r2        = (int64_t)radius * radius; // a wide map's radius squared overflows int
+    double  new_start = 0;
+    for (int j = distance; j <= (int)radius; ++j) {
+        int  dx      = -j - 1;
+        int  dy      = -j;
+        bool blocked = false;
+        while (dx <= 0) {
+            dx += 1;
+            int    x       = col + dx * xx + dy * xy;
+            int    y       = row + dx * yx + dy * yy;
+            double l_slope = (dx - 0.5) / (dy + 0.5);
+            double r_slope = (dx + 0.5) / (dy - 0.5);
+            if (start < r_slope) { continue; }
+            if (end > l_slope) { break; }
+
+            if ((int64_t)dx * dx + (int64_t)dy * dy <= r2) { light(y, x, visible); }
+            if (blocked) {
+                if (blocks(y, x)) {
+                    new_start = r_slope;
+                } else {
+                    blocked = false;
+                    start   = new_start;
+                }
+            } else if (blocks(y, x) && (j < (int)radius)) {
+                blocked = true;
+                cast_light(row, col, j + 1, start, l_slope, xx, xy, yx, yy, visible);
+                new_start = r_slope;
+            }
+        }
+        if (blocked) { break; }
+    }
+}
+
+/**
+ * @brief cells a player on cell can see, walls that bound the view included.
+ *
+ * @param cell viewer's cell.
+ * @return const std::vector<unsigned int>& visible cells, valid until the next call.
+ */
+const std::vector<unsigned int> &Field_of_view::visible_from(unsigned int cell) {
+    // octant transforms, one column per octant
+    static const int mult[4][8] = {{1, 0, 0, -1, -1, 0, 0, 1},
+                                   {0, 1, -1, 0, 0, -1, 1, 0},
+                                   {0, 1, 1, 0, 0, -1, -1, 0},
+                                   {1, 0, 0, 1, -1, 0, 0, -1}};
+
+    auto found = cache.find(cell);
+    if (found != cache.end()) { return found->second; }
+
+    if (cached_cells > FOV_CACHE_MAX_CELLS) {
+        cache.clear();
+        cached_cells = 0;
+    }
+
+    std::vector<unsigned int> &visible = cache[cell];
+    int                        row     = cell / planes.get_cols();
+    int                        col     = cell % planes.get_cols();
+
+    light(row, col, visible);
+    for (int oct = 0; oct < 8; ++oct) {
+        cast_light(row, col, 1, 1.0, 0.0, mult[0][oct], mult[1][oct], mult[2][oct],
+                   mult[3][oct], visible);
+    }
+    for (unsigned int c : visible) { lit[c >> 6] = 0; }
+    cached_cells += visible.size();
+    return visible;
+}
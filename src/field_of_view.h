@@ -0,0 +1,42 @@
+#ifndef __FIELD_OF_VIEW_H__
+#define __FIELD_OF_VIEW_H__
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+#include "cell_planes.h"
+
+#define FOG_ENV "GOLDCHASE_FOG"      // sight radius in cells, fog of war when set
+#define FOV_CACHE_MAX_CELLS (1 << 20) // cached visible cells kept before starting over
+
+/**
+ * @brief what can be seen from a cell, by recursive shadowcasting over the wall
+ *          plane. Walls never move, so the result only depends on the cell and is
+ *          cached; walking back and forth costs a lookup.
+ */
+class Field_of_view {
+  private:
+    Cell_planes  planes;
+    unsigned int radius;
+
+    std::unordered_map<unsigned int, std::vector<unsigned int>> cache;
+    size_t                                                      cached_cells = 0;
+
+    // cells lit by the cast in progress, a bit per cell; de-duplicates cells on
+    // octant borders and is cleared again from the visible list
+    std::vector<uint64_t> lit;
+
+    void cast_light(int row, int col, int distance, double start, double end, int xx,
+                    int xy, int yx, int yy, std::vector<unsigned int> &visible);
+    void light(int row, int col, std::vector<unsigned int> &visible);
+    bool blocks(int row, int col) const;
+
+  public:
+    Field_of_view(const Cell_planes &planes, unsigned int radius);
+
+    const std::vector<unsigned int> &visible_from(unsigned int cell);
+    size_t                           get_cache_size() const { return cache.size(); }
+};
+
+#endif // __FIELD_OF_VIEW_H__
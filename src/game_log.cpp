@@ -0,0 +1,225 @@
+/**
+ * @file game_log.cpp
+ * @author Feras Alshehri (falshehri@mail.csuchico.edu)
+ * @brief asynchronous logging: any thread formats its record into a lock-free
+ *          ring, and a flusher thread writes the ring to the log file, so a
+ *          record costs a few hundred ns and never waits on the terminal or
+ *          the disk, even with the semaphore held.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <sys/syscall.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+
+#include "game_log.h"
+
+#define STDERR_TEXT_BYTES 1024 // messages are only cut to fit the ring
+
+// one slot of the ring. sequence says whose turn the slot is: pos while free for
+// the producer claiming position pos, pos + 1 once that record is complete, and
+// pos + LOG_RING_RECORDS when the flusher hands it back for the next lap
+struct log_record_S {
+    std::atomic<uint64_t> sequence;
+    uint64_t              ns; // CLOCK_REALTIME
+    uint32_t              tid;
+    int32_t               err; // errno to explain the message with, 0 for none
+    LOG_LEVEL_E           level;
+    char                  text[LOG_TEXT_BYTES];
+};
+
+static log_record_S          ring[LOG_RING_RECORDS];
+static std::atomic<uint64_t> enqueue_pos(0);
+static uint64_t              dequeue_pos = 0; // the flusher's alone
+static std::atomic<uint64_t> dropped(0);
+static uint64_t              dropped_reported = 0;
+static uint64_t              problems         = 0; // warnings and errors written
+static std::atomic<bool>     started(false);
+
+static FILE                   *out = nullptr;
+static std::string             path;
+static std::thread             flusher;
+static std::mutex              stop_mutex; // only the flusher and log_stop() take it
+static std::condition_variable stop_cv;
+static bool                    stopping = false;
+
+const char *log_level_name(LOG_LEVEL_E level) {
+    switch (level) {
+    case log_debug:
+        return "DEBUG";
+    case log_info:
+        return "INFO";
+    case log_warn:
+        return "WARN";
+    default:
+        return "ERROR";
+    }
+}
+
+/**
+ * @brief write the completed records at the head of the ring to the file, and
+ *          hand their slots back.
+ */
+static void drain() {
+    while (true) {
+        log_record_S &r = ring[dequeue_pos & (LOG_RING_RECORDS - 1)];
+        if (r.sequence.load(std::memory_order_acquire) != dequeue_pos + 1) { break; }
+
+        time_t    secs = r.ns / 1000000000ull;
+        struct tm local;
+        char      stamp[32];
+        localtime_r(&secs, &local);
+        strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &local);
+        fprintf(out, "%s.%06u %-5s %d/%u %s", stamp, (unsigned)(r.ns % 1000000000ull / 1000),
+                log_level_name(r.level), (int)getpid(), r.tid, r.text);
+        if (r.err != 0) { fprintf(out, ": %s", strerror(r.err)); }
+        fputc('\n', out);
+        problems += (r.level >= log_warn);
+
+        r.sequence.store(dequeue_pos + LOG_RING_RECORDS, std::memory_order_release);
+        ++dequeue_pos;
+    }
+
+    uint64_t lost = dropped.load(std::memory_order_relaxed);
+    if (lost != dropped_reported) {
+        fprintf(out, "-- %llu records dropped, the ring was full\n",
+                (unsigned long long)(lost - dropped_reported));
+        dropped_reported = lost;
+    }
+    fflush(out);
+}
+
+static void flush_loop() {
+    std::unique_lock<std::mutex> lock(stop_mutex);
+    while (!stopping) {
+        lock.unlock();
+        drain();
+        lock.lock();
+        stop_cv.wait_for(lock, std::chrono::milliseconds(LOG_FLUSH_MS),
+                         [] { return stopping; });
+    }
+}
+
+/**
+ * @brief send records to the log file from now on, e.g. once the game has the
+ *          terminal.
+ *
+ * @return false if the file can't be opened, records keep going to stderr.
+ */
+bool log_start() {
+    if (started.load()) { return true; }
+
+    const char *env = getenv(LOG_ENV);
+    path = env ? env : "/tmp/goldchase." + std::to_string(getpid()) + ".log";
+    out  = fopen(path.c_str(), "ae");
+    if (out == nullptr) { return false; }
+
+    for (uint64_t i = 0; i < LOG_RING_RECORDS; ++i) {
+        ring[i].sequence.store(i + dequeue_pos, std::memory_order_relaxed);
+    }
+    enqueue_pos.store(dequeue_pos, std::memory_order_relaxed);
+    stopping = false;
+    flusher  = std::thread(flush_loop);
+    started.store(true, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief write what is left in the ring, stop the flusher, and go back to
+ *          stderr, e.g. once the terminal is restored. The other threads that
+ *          log must be done by then. If anything went wrong, says where to look.
+ */
+void log_stop() {
+    if (!started.load()) { return; }
+    started.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex);
+        stopping = true;
+    }
+    stop_cv.notify_one();
+    flusher.join();
+    drain();
+    fclose(out);
+    out = nullptr;
+
+    if (problems != 0) {
+        fprintf(stderr, "%llu warnings and errors logged to %s\n",
+                (unsigned long long)problems, path.c_str());
+        problems = 0;
+    }
+}
+
+/**
+ * @brief log a message. Wait free: the slot is claimed with one compare and swap,
+ *          and if the flusher has fallen a whole ring behind the record is dropped
+ *          rather than waited for.
+ *
+ * @param level of the message.
+ * @param err errno to append the description of, as perror() does; 0 for none.
+ * @param format printf style.
+ */
+void log_write(LOG_LEVEL_E level, int err, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+
+    if (!started.load(std::memory_order_acquire)) {
+        char text[STDERR_TEXT_BYTES];
+        vsnprintf(text, sizeof(text), format, args);
+        va_end(args);
+        if (err != 0) {
+            fprintf(stderr, "%s: %s\n", text, strerror(err));
+        } else {
+            fprintf(stderr, "%s\n", text);
+        }
+        return;
+    }
+
+    static thread_local uint32_t tid = (uint32_t)syscall(SYS_gettid);
+    uint64_t                     pos = enqueue_pos.load(std::memory_order_relaxed);
+    log_record_S                *r;
+    while (true) {
+        r            = &ring[pos & (LOG_RING_RECORDS - 1)];
+        int64_t turn = (int64_t)(r->sequence.load(std::memory_order_acquire) - pos);
+        if (turn == 0) {
+            if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (turn < 0) {
+            // the slot still holds the record from a lap ago
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            va_end(args);
+            return;
+        } else {
+            pos = enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    r->ns    = (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+    r->tid   = tid;
+    r->err   = err;
+    r->level = level;
+    vsnprintf(r->text, sizeof(r->text), format, args);
+    va_end(args);
+    r->sequence.store(pos + 1, std::memory_order_release);
+}
+
+/**
+ * @brief records lost to a full ring since the process started.
+ */
+uint64_t log_get_dropped() { return dropped.load(std::memory_order_relaxed); }
@@ -0,0 +1,38 @@
+#ifndef __GAME_LOG_H__
+#define __GAME_LOG_H__
+
+#include <errno.h>
+#include <stdint.h>
+
+// Log records go to a per-process lock-free ring and are written to
+// $GOLDCHASE_LOG (default /tmp/goldchase.<pid>.log) by a flusher thread, once
+// log_start() ran; before that, and after log_stop(), they go to stderr as they
+// are made. LOG_DEBUG compiles to nothing, arguments included, unless built with
+// -DGOLDCHASE_LOG_DEBUG (make LOG_DEBUG=1).
+
+#define LOG_ENV "GOLDCHASE_LOG"
+#define LOG_RING_RECORDS 1024 // power of two; when full, records are dropped and counted
+#define LOG_TEXT_BYTES 228    // longer messages are cut; a record is 256 bytes
+#define LOG_FLUSH_MS 50       // the flusher empties the ring this often
+
+enum LOG_LEVEL_E { log_debug, log_info, log_warn, log_error };
+
+bool        log_start();
+void        log_stop();
+void        log_write(LOG_LEVEL_E level, int err, const char *format, ...)
+    __attribute__((format(printf, 3, 4)));
+uint64_t    log_get_dropped();
+const char *log_level_name(LOG_LEVEL_E level);
+
+#ifdef GOLDCHASE_LOG_DEBUG
+#define LOG_DEBUG(...) log_write(log_debug, 0, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+#define LOG_INFO(...) log_write(log_info, 0, __VA_ARGS__)
+#define LOG_WARN(...) log_write(log_warn, 0, __VA_ARGS__)
+#define LOG_ERROR(...) log_write(log_error, 0, __VA_ARGS__)
+// like perror(): the message, then what errno says
+#define LOG_ERRNO(...) log_write(log_error, errno, __VA_ARGS__)
+
+#endif // __GAME_LOG_H__
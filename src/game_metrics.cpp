@@ -0,0 +1,30 @@
+/**
+ * @file game_metrics.cpp
+ * @author Feras Alshehri (falshehri@mail.csuchico.edu)
+ * @brief per player counters kept in the shared segment, read by mine_stats.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "game_metrics.h"
+
+/**
+ * @brief account one wait for the game semaphore.
+ *
+ * @param m metrics of the calling player.
+ * @param wait_ns time between wanting the semaphore and getting it.
+ */
+void metrics_record_lock_wait(player_metrics_S &m, uint64_t wait_ns) {
+    uint64_t     us     = wait_ns / 1000;
+    unsigned int bucket = 0;
+
+    while ((bucket < METRICS_LOCK_WAIT_BUCKETS - 1) && (us >= (1ull << bucket))) {
+        ++bucket;
+    }
+
+    metrics_add(m.lock_wait_ns_total, wait_ns);
+    metrics_add(m.lock_wait_hist[bucket]);
+}
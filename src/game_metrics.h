@@ -0,0 +1,55 @@
+#ifndef __GAME_METRICS_H__
+#define __GAME_METRICS_H__
+
+#include <stdint.h>
+
+// lock wait histogram bucket i counts waits shorter than 2^i microseconds, the last
+// bucket counts everything longer
+#define METRICS_LOCK_WAIT_BUCKETS 16
+
+/**
+ * @brief counters of one player slot. Each slot is only ever written by the process
+ *          owning that player and sits on its own cache lines, so updating it needs
+ *          no atomic read-modify-write and never bounces lines between players.
+ */
+struct alignas(64) player_metrics_S {
+    uint64_t joins;
+    uint64_t moves;
+    uint64_t rejected_moves;
+    uint64_t real_gold_found;
+    uint64_t fools_gold_found;
+    uint64_t frames_drawn;
+    uint64_t frames_dropped; // published but replaced before the renderer got to them
+    uint64_t cells_plotted;
+    uint64_t bytes_written; // to the terminal, by every frame so far
+    uint64_t lock_wait_ns_total;
+    uint64_t lock_wait_hist[METRICS_LOCK_WAIT_BUCKETS];
+};
+
+struct game_metrics_S {
+    player_metrics_S players[5]; // indexed by player number - 1
+};
+
+/**
+ * @brief add to a counter owned by the calling process. Readers in other processes
+ *          see whole 64 bit values, never torn ones.
+ *
+ * @param counter counter in the shared segment.
+ * @param n amount to add.
+ */
+inline void metrics_add(uint64_t &counter, uint64_t n = 1) {
+    __atomic_store_n(&counter, __atomic_load_n(&counter, __ATOMIC_RELAXED) + n,
+                     __ATOMIC_RELAXED);
+}
+
+inline void metrics_set(uint64_t &counter, uint64_t value) {
+    __atomic_store_n(&counter, value, __ATOMIC_RELAXED);
+}
+
+inline uint64_t metrics_read(const uint64_t &counter) {
+    return __atomic_load_n(&counter, __ATOMIC_RELAXED);
+}
+
+void metrics_record_lock_wait(player_metrics_S &m, uint64_t wait_ns);
+
+#endif // __GAME_METRICS_H__
@@ -0,0 +1,129 @@
+/**
+ * @file game_session.cpp
+ * @author Feras Alshehri (falshehri@mail.csuchico.edu)
+ * @brief a player session as coroutines, so one thread can host many of them.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "game_session.h"
+#include "move_rules.h"
+
+/**
+ * @brief bump the game generation, as goldmine_publish_change() does for the game
+ *          segment. Called with the semaphore held.
+ */
+static void publish_change(game_S &game) {
+    __atomic_add_fetch(game.generation, 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief wake whoever sleeps on the generation in other processes, as
+ *          goldmine_wake_watchers() does. Called after giving the semaphore back so
+ *          the woken don't run straight into it.
+ */
+static void wake_watchers(game_S &game) {
+    syscall(SYS_futex, game.generation, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+/**
+ * @brief apply one key with the semaphore held, by the same rules as controller()
+ *          in mine_entrance.cpp (see apply_move()).
+ *
+ * @return true if the session is over (game won, or 'q').
+ */
+static bool apply_key(game_S &game, session_S &s, int key, bool &changed) {
+    if ((key == 'q') || (key == 'Q')) { return true; }
+
+    DIRECTION_E direction = direction_of_key(key);
+    if (direction == dir_none) { return false; }
+
+    move_context_S context = {game.planes, game.spatial, game.journal, &s.metrics};
+    switch (apply_move(context, s.player, direction, s.position, s.has_gold)) {
+    case move_exit:
+        s.won = true;
+        return true;
+
+    case move_ok:
+        // fall through
+    case move_found_gold:
+        // fall through
+    case move_found_fools_gold:
+        changed = true;
+        break;
+
+    case move_blocked:
+        // fall through
+    case move_off_map:
+        break;
+    }
+    return false;
+}
+
+/**
+ * @brief the input side of a session: wait for keys, then apply everything that
+ *          was typed under one acquisition of the semaphore, as apply_moves() does.
+ *          Leaves the map and closes the fd when the keys run out, on 'q' or on
+ *          winning.
+ *
+ * @param loop loop running the session.
+ * @param game game the player is in.
+ * @param session the player.
+ */
+Session_task play_session(Event_loop &loop, game_S &game, session_S &session) {
+    unsigned char buf[256];
+    bool          over = false;
+
+    while (!over) {
+        co_await loop.readable(session.fd);
+        ssize_t n = read(session.fd, buf, sizeof(buf));
+        if (n <= 0) { break; }
+
+        co_await loop.lock(game.semaphore);
+        bool changed = false;
+        for (ssize_t i = 0; (i < n) && !over; ++i) {
+            over = apply_key(game, session, buf[i], changed);
+        }
+        if (changed) { publish_change(game); }
+        sem_post(game.semaphore);
+        if (changed) { wake_watchers(game); }
+    }
+
+    close(session.fd);
+    co_await loop.lock(game.semaphore);
+    unsigned int cell = session.position.cell;
+    game.planes.set_players(cell, 0);
+    if (game.spatial != nullptr) { game.spatial->remove(cell, session.player); }
+    if (game.journal != nullptr) {
+        game.journal->record(journal_leave, session.player, cell, cell);
+    }
+    session.done = true;
+    publish_change(game);
+    sem_post(game.semaphore);
+    wake_watchers(game);
+}
+
+/**
+ * @brief the display side of a session: wake on every change of the map, where a
+ *          terminal session would draw a frame. Ends once the player has left.
+ *
+ * @param loop loop running the session.
+ * @param game game the player is in.
+ * @param session the player.
+ */
+Session_task watch_session(Event_loop &loop, game_S &game, session_S &session) {
+    unsigned int seen = __atomic_load_n(game.generation, __ATOMIC_ACQUIRE);
+
+    while (!session.done) {
+        seen = co_await loop.changed(game.generation, seen);
+        session.frames++;
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef __GAME_SESSION_H__
+#define __GAME_SESSION_H__
+
+#include <semaphore.h>
+#include <stdint.h>
+
+#include "cell_planes.h"
+#include "event_loop.h"
+#include "game_metrics.h"
+#include "move_journal.h"
+#include "move_kernel.h"
+#include "spatial_index.h"
+
+// one game as a session host sees it: the map, the semaphore guarding it and the
+// generation bumped on every change (see goldmine_publish_change()). spatial and
+// journal are nullptr for a game that doesn't keep them.
+struct game_S {
+    Cell_planes    planes;
+    sem_t         *semaphore;
+    unsigned int  *generation;
+    Spatial_index *spatial;
+    Move_journal  *journal;
+};
+
+// one player's session in a game. The player has joined already (its bit is on
+// the map at position) when the session starts.
+struct session_S {
+    int              fd;     // keys, the session ends (and closes it) at EOF or 'q'
+    unsigned char    player; // player bit
+    move_position_S  position;
+    bool             has_gold;
+    bool             won;
+    bool             done;
+    player_metrics_S metrics;
+    uint64_t         frames; // map changes seen, see watch_session()
+};
+
+Session_task play_session(Event_loop &loop, game_S &game, session_S &session);
+Session_task watch_session(Event_loop &loop, game_S &game, session_S &session);
+
+#endif // __GAME_SESSION_H__
@@ -0,0 +1,48 @@
+#ifndef __MAP_FORMAT_H__
+#define __MAP_FORMAT_H__
+
+#include <stdint.h>
+
+// binary map files start with this magic instead of the gold count line
+#define MAP_BINARY_MAGIC "GMAP"
+#define MAP_BINARY_VERSION 1 // cells as bytes, row major
+#define MAP_TILED_VERSION 2  // walls as bitset tiles, see below
+#define MAP_TILE_SHIFT 6
+#define MAP_TILE_SIDE (1u << MAP_TILE_SHIFT) // tiles are 64 x 64 cells
+#define MAP_TILE_BYTES (MAP_TILE_SIDE * sizeof(uint64_t))
+
+/**
+ * @brief header of a binary map file. In a MAP_BINARY_VERSION file it is followed
+ *          by rows * cols bytes in row major order, each either 0 (empty) or
+ *          G_WALL.
+ *
+ *        A MAP_TILED_VERSION file holds the walls in MAP_TILE_SIDE square tiles
+ *        instead, tile rows top to bottom and tiles left to right in each. A tile
+ *        is one 64 bit word per row, bit x set for a wall in column x of the tile;
+ *        cells past the edge of the map are walls. Any tile is a single read at a
+ *        known offset, see map_tile_offset(), so a map can be read piece by
+ *        piece (mine_bench world). The game loads tiled maps whole, up to 0xFFFF
+ *        a side.
+ */
+struct map_binary_header_S {
+    char     magic[4];
+    uint32_t version;
+    uint32_t rows;
+    uint32_t cols;
+    uint32_t total_num_gold;
+    uint32_t reserved[3];
+};
+
+/**
+ * @brief file offset of a tile of a MAP_TILED_VERSION map.
+ *
+ * @param cols columns of the map.
+ * @param tile_row tile row, cell row / MAP_TILE_SIDE.
+ * @param tile_col tile column, cell column / MAP_TILE_SIDE.
+ */
+inline uint64_t map_tile_offset(uint64_t cols, uint64_t tile_row, uint64_t tile_col) {
+    uint64_t tiles_across = (cols + MAP_TILE_SIDE - 1) / MAP_TILE_SIDE;
+    return sizeof(map_binary_header_S) + (tile_row * tiles_across + tile_col) * MAP_TILE_BYTES;
+}
+
+#endif // __MAP_FORMAT_H__
@@ -0,0 +1,418 @@
+/**
+ * @file map_generator.cpp
+ * @author Feras Alshehri (falshehri@mail.csuchico.edu)
+ * @brief procedural map generator writing maps the game can load, either in the
+ *          text format of mymap.txt or in the binary format of map_format.h.
+ *
+ *        Every cell is a pure function of (seed, row, col), so the map is built in
+ *        independent bands of rows by a pool of threads and streamed out band by
+ *        band, in order. Only a few bands are ever held in memory.
+ *
+ *        usage: mine_mapgen <maze|cave|rooms> <rows> <cols> [-s seed] [-g gold]
+ *                           [-t threads] [-b | -p] [-o file]
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "goldchase.h"
+#include "map_format.h"
+
+#define BAND_ROWS 256 // a multiple of MAP_TILE_SIDE, so bands hold whole tile rows
+#define GAME_MAX_SIDE 0xFFFF    // the game stores rows/cols as unsigned short
+#define PAGED_MAX_SIDE (1u << 20) // larger tiled maps are only read a chunk at a time
+#define CAVE_ITERATIONS 4
+#define CAVE_WALL_PERCENT 45
+#define ROOM_SECTOR 24
+
+enum GENERATOR_MODE_E { mode_maze, mode_cave, mode_rooms };
+
+struct generator_options_S {
+    GENERATOR_MODE_E mode    = mode_maze;
+    unsigned int     rows    = 0;
+    unsigned int     cols    = 0;
+    uint64_t         seed    = 1;
+    unsigned int     gold    = 10;
+    unsigned int     threads = 0;
+    bool             binary  = false;
+    bool             tiled   = false;
+    std::string      output  = "";
+};
+
+/**
+ * @brief stateless hash of a seed and up to three coordinates (splitmix64 finalizer).
+ *
+ * @return uint64_t well mixed 64 bit value.
+ */
+static uint64_t cell_hash(uint64_t seed, uint64_t a, uint64_t b, uint64_t c = 0) {
+    uint64_t z = seed + a * 0x9e3779b97f4a7c15ull + b * 0xbf58476d1ce4e5b9ull +
+                 c * 0x94d049bb133111ebull;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief sidewinder maze. Maze cells sit on odd (row, col) coordinates and the
+ *          passages between them are carved per maze row, so any row of the output
+ *          only depends on one maze row.
+ *
+ * @param opt generator options.
+ * @param y0 first output row of the band.
+ * @param y1 one past the last output row of the band.
+ * @param out band cells, (y1 - y0) * cols, 1 = wall.
+ */
+static void generate_maze(const generator_options_S &opt, unsigned int y0,
+                          unsigned int y1, std::vector<unsigned char> &out) {
+    unsigned int      maze_cols = (opt.cols - 1) / 2;
+    unsigned int      maze_rows = (opt.rows - 1) / 2;
+    std::vector<bool> east(maze_cols), north(maze_cols);
+
+    auto carve_row = [&](unsigned int i) {
+        std::fill(east.begin(), east.end(), false);
+        std::fill(north.begin(), north.end(), false);
+        unsigned int run_start = 0;
+        for (unsigned int j = 0; j < maze_cols; ++j) {
+            bool close = (j + 1 == maze_cols) ||
+                         ((i > 0) && (cell_hash(opt.seed, i, j, 0) & 1));
+            if (!close) {
+                east[j] = true;
+                continue;
+            }
+            if (i > 0) {
+                unsigned int len = j - run_start + 1;
+                north[run_start + cell_hash(opt.seed, i, run_start, 1) % len] = true;
+            }
+            run_start = j + 1;
+        }
+    };
+
+    std::fill(out.begin(), out.end(), 1);
+    unsigned int carved = 0xFFFFFFFF;
+    for (unsigned int y = y0; y < y1; ++y) {
+        unsigned char *row = &out[(y - y0) * opt.cols];
+        unsigned int   i   = (y % 2) ? (y - 1) / 2 : y / 2;
+
+        if (i < maze_rows && i != carved) {
+            carve_row(i);
+            carved = i;
+        }
+        for (unsigned int j = 0; j < maze_cols && i < maze_rows; ++j) {
+            if (y % 2) {
+                row[2 * j + 1] = 0;
+                if (east[j]) { row[2 * j + 2] = 0; }
+            } else if (north[j]) {
+                row[2 * j + 1] = 0;
+            }
+        }
+    }
+
+    // entrance on the top edge, exit from the last maze cell down to the bottom edge
+    if (y0 == 0 && maze_cols > 0) { out[1] = 0; }
+    if (maze_rows > 0 && maze_cols > 0) {
+        unsigned int last_y = 2 * (maze_rows - 1) + 1;
+        unsigned int exit_x = 2 * (maze_cols - 1) + 1;
+        for (unsigned int y = std::max(y0, last_y + 1); y < y1; ++y) {
+            out[(y - y0) * opt.cols + exit_x] = 0;
+        }
+    }
+}
+
+/**
+ * @brief cellular automata caves. Starts from hashed noise and applies the 4-5 rule
+ *          a few times. The band is computed with a halo of CAVE_ITERATIONS rows on
+ *          each side so bands agree with each other at their seams.
+ *
+ * @param opt generator options.
+ * @param y0 first output row of the band.
+ * @param y1 one past the last output row of the band.
+ * @param out band cells, (y1 - y0) * cols, 1 = wall.
+ */
+static void generate_cave(const generator_options_S &opt, unsigned int y0,
+                          unsigned int y1, std::vector<unsigned char> &out) {
+    unsigned int h0   = (y0 > CAVE_ITERATIONS) ? y0 - CAVE_ITERATIONS : 0;
+    unsigned int h1   = std::min(y1 + CAVE_ITERATIONS, opt.rows);
+    unsigned int cols = opt.cols;
+
+    std::vector<unsigned char> cur((h1 - h0) * cols), next((h1 - h0) * cols);
+    for (unsigned int y = h0; y < h1; ++y) {
+        for (unsigned int x = 0; x < cols; ++x) {
+            cur[(y - h0) * cols + x] =
+                (cell_hash(opt.seed, y, x) % 100) < CAVE_WALL_PERCENT;
+        }
+    }
+
+    // cells off the map count as open so the caves spill out to the edge. The 3x3
+    // wall count is split into horizontal 3-sums, then summed over 3 rows.
+    std::vector<unsigned char> hsum((h1 - h0) * cols);
+    for (int it = 0; it < CAVE_ITERATIONS; ++it) {
+        for (unsigned int y = 0; y < h1 - h0; ++y) {
+            const unsigned char *c = &cur[y * cols];
+            unsigned char       *h = &hsum[y * cols];
+            for (unsigned int x = 0; x < cols; ++x) {
+                h[x] = c[x] + (x > 0 ? c[x - 1] : 0) + (x + 1 < cols ? c[x + 1] : 0);
+            }
+        }
+        for (unsigned int y = 0; y < h1 - h0; ++y) {
+            const unsigned char *up   = (y > 0) ? &hsum[(y - 1) * cols] : nullptr;
+            const unsigned char *mid  = &hsum[y * cols];
+            const unsigned char *down = (y + 1 < h1 - h0) ? &hsum[(y + 1) * cols] : nullptr;
+            unsigned char       *n    = &next[y * cols];
+            for (unsigned int x = 0; x < cols; ++x) {
+                int walls = mid[x] + (up ? up[x] : 0) + (down ? down[x] : 0);
+                n[x]      = walls >= 5;
+            }
+        }
+        cur.swap(next);
+    }
+
+    std::memcpy(out.data(), &cur[(y0 - h0) * cols], (y1 - y0) * cols);
+}
+
+/**
+ * @brief room of a sector: every ROOM_SECTOR x ROOM_SECTOR sector holds one room.
+ */
+struct room_S {
+    long top, left, bottom, right; // inclusive bounds
+    long cy, cx;                   // center, where corridors attach
+};
+
+static room_S sector_room(const generator_options_S &opt, long sy, long sx) {
+    uint64_t h = cell_hash(opt.seed, sy, sx, 2);
+    long     w = 4 + h % (ROOM_SECTOR - 8);
+    long     t = 4 + (h >> 16) % (ROOM_SECTOR - 8);
+    room_S   r;
+    r.left   = sx * ROOM_SECTOR + 1 + (h >> 32) % (ROOM_SECTOR - w - 1);
+    r.top    = sy * ROOM_SECTOR + 1 + (h >> 48) % (ROOM_SECTOR - t - 1);
+    r.right  = r.left + w - 1;
+    r.bottom = r.top + t - 1;
+    r.cy     = (r.top + r.bottom) / 2;
+    r.cx     = (r.left + r.right) / 2;
+    return r;
+}
+
+/**
+ * @brief is (y, x) on the L shaped corridor joining two room centers, first along
+ *          the row of a, then along the column of b.
+ */
+static bool on_corridor(const room_S &a, const room_S &b, long y, long x) {
+    if (y == a.cy && x >= std::min(a.cx, b.cx) && x <= std::max(a.cx, b.cx)) {
+        return true;
+    }
+    return x == b.cx && y >= std::min(a.cy, b.cy) && y <= std::max(a.cy, b.cy);
+}
+
+/**
+ * @brief rooms and corridors. Each room is joined to the rooms of the sectors to
+ *          its east and south; a cell only needs to look at its own sector's room
+ *          and the four corridors that can cross that sector.
+ *
+ * @param opt generator options.
+ * @param y0 first output row of the band.
+ * @param y1 one past the last output row of the band.
+ * @param out band cells, (y1 - y0) * cols, 1 = wall.
+ */
+static void generate_rooms(const generator_options_S &opt, unsigned int y0,
+                           unsigned int y1, std::vector<unsigned char> &out) {
+    long sectors_y = (opt.rows + ROOM_SECTOR - 1) / ROOM_SECTOR;
+    long sectors_x = (opt.cols + ROOM_SECTOR - 1) / ROOM_SECTOR;
+
+    for (unsigned int y = y0; y < y1; ++y) {
+        long sy = y / ROOM_SECTOR;
+        for (long sx = 0; sx < sectors_x; ++sx) {
+            room_S me    = sector_room(opt, sy, sx);
+            bool   has_w = sx > 0, has_e = sx + 1 < sectors_x;
+            bool   has_n = sy > 0, has_s = sy + 1 < sectors_y;
+            room_S west  = has_w ? sector_room(opt, sy, sx - 1) : me;
+            room_S east  = has_e ? sector_room(opt, sy, sx + 1) : me;
+            room_S north = has_n ? sector_room(opt, sy - 1, sx) : me;
+            room_S south = has_s ? sector_room(opt, sy + 1, sx) : me;
+
+            long x_end = std::min((sx + 1) * ROOM_SECTOR, (long)opt.cols);
+            for (long x = sx * ROOM_SECTOR; x < x_end; ++x) {
+                bool open = (y >= me.top && y <= me.bottom && x >= me.left &&
+                             x <= me.right) ||
+                            (has_w && on_corridor(west, me, y, x)) ||
+                            (has_e && on_corridor(me, east, y, x)) ||
+                            (has_n && on_corridor(me, north, y, x)) ||
+                            (has_s && on_corridor(south, me, y, x)) ||
+                            (sy == 0 && sx == 0 && x == me.cx && (long)y <= me.cy);
+                out[(y - y0) * opt.cols + x] = !open;
+            }
+        }
+    }
+}
+
+/**
+ * @brief render one band of cells into the bytes that go to the output file.
+ *
+ * @param opt generator options.
+ * @param band band index.
+ * @param text output buffer.
+ */
+static void generate_band(const generator_options_S &opt, unsigned int band,
+                          std::string &text) {
+    unsigned int y0 = band * BAND_ROWS;
+    unsigned int y1 = std::min(y0 + BAND_ROWS, opt.rows);
+
+    std::vector<unsigned char> cells((y1 - y0) * opt.cols);
+    switch (opt.mode) {
+    case mode_maze:
+        generate_maze(opt, y0, y1, cells);
+        break;
+    case mode_cave:
+        generate_cave(opt, y0, y1, cells);
+        break;
+    case mode_rooms:
+        generate_rooms(opt, y0, y1, cells);
+        break;
+    }
+
+    if (opt.tiled) {
+        // whole tiles, padded with walls past the edges of the map
+        uint64_t tiles_across = (opt.cols + MAP_TILE_SIDE - 1) / MAP_TILE_SIDE;
+        uint64_t tile_rows    = (y1 - y0 + MAP_TILE_SIDE - 1) / MAP_TILE_SIDE;
+        text.assign(tile_rows * tiles_across * MAP_TILE_BYTES, 0);
+        uint64_t *words = (uint64_t *)text.data();
+        for (uint64_t t = 0; t < tile_rows * tiles_across; ++t) {
+            uint64_t tile_row = t / tiles_across, tile_col = t % tiles_across;
+            for (unsigned int r = 0; r < MAP_TILE_SIDE; ++r) {
+                uint64_t     y    = tile_row * MAP_TILE_SIDE + r;
+                uint64_t     word = ~0ull;
+                unsigned int x0   = tile_col * MAP_TILE_SIDE;
+                for (unsigned int c = 0; (y < y1 - y0) && (c < MAP_TILE_SIDE); ++c) {
+                    if ((x0 + c < opt.cols) && !cells[y * opt.cols + x0 + c]) {
+                        word &= ~(1ull << c);
+                    }
+                }
+                words[t * MAP_TILE_SIDE + r] = word;
+            }
+        }
+    } else if (opt.binary) {
+        text.resize(cells.size());
+        for (size_t i = 0; i < cells.size(); ++i) { text[i] = cells[i] ? G_WALL : 0; }
+    } else {
+        text.resize(cells.size() + (y1 - y0));
+        size_t o = 0;
+        for (unsigned int y = 0; y < y1 - y0; ++y) {
+            for (unsigned int x = 0; x < opt.cols; ++x) {
+                text[o++] = cells[y * opt.cols + x] ? '*' : ' ';
+            }
+            text[o++] = '\n';
+        }
+    }
+}
+
+static void usage() {
+    std::cerr << "usage: mine_mapgen <maze|cave|rooms> <rows> <cols> [-s seed] "
+                 "[-g gold] [-t threads] [-b | -p] [-o file]\n"
+              << "  -s seed     generator seed (default 1)\n"
+              << "  -g gold     total gold count written to the map (default 10)\n"
+              << "  -t threads  worker threads (default: all cores)\n"
+              << "  -b          write the binary map format instead of text\n"
+              << "  -p          write the tiled binary format, for worlds too large to\n"
+              << "              load whole (up to " << PAGED_MAX_SIDE << " a side)\n"
+              << "  -o file     output file (default: stdout)\n";
+}
+
+static bool parse_args(int argc, char *argv[], generator_options_S &opt) {
+    if (argc < 4) { return false; }
+
+    std::string mode = argv[1];
+    if (mode == "maze") {
+        opt.mode = mode_maze;
+    } else if (mode == "cave") {
+        opt.mode = mode_cave;
+    } else if (mode == "rooms") {
+        opt.mode = mode_rooms;
+    } else {
+        return false;
+    }
+    opt.rows = std::stoul(argv[2]);
+    opt.cols = std::stoul(argv[3]);
+
+    for (int i = 4; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "-b") {
+            opt.binary = true;
+        } else if (a == "-p") {
+            opt.tiled = true;
+        } else if (i + 1 < argc && a == "-s") {
+            opt.seed = std::stoull(argv[++i]);
+        } else if (i + 1 < argc && a == "-g") {
+            opt.gold = std::stoul(argv[++i]);
+        } else if (i + 1 < argc && a == "-t") {
+            opt.threads = std::stoul(argv[++i]);
+        } else if (i + 1 < argc && a == "-o") {
+            opt.output = argv[++i];
+        } else {
+            return false;
+        }
+    }
+
+    unsigned int max_side = opt.tiled ? PAGED_MAX_SIDE : GAME_MAX_SIDE;
+    return opt.rows > 2 && opt.cols > 2 && opt.rows <= max_side && opt.cols <= max_side &&
+           opt.gold > 0 && !(opt.binary && opt.tiled);
+}
+
+int main(int argc, char *argv[]) {
+    generator_options_S opt;
+
+    if (!parse_args(argc, argv, opt)) {
+        usage();
+        return 1;
+    }
+    if (opt.threads == 0) { opt.threads = std::max(1u, std::thread::hardware_concurrency()); }
+
+    FILE *out = opt.output.empty() ? stdout : fopen(opt.output.c_str(), "wb");
+    if (out == nullptr) {
+        perror("ERROR: could not open output file");
+        return 1;
+    }
+
+    if (opt.binary || opt.tiled) {
+        map_binary_header_S header = {};
+        std::memcpy(header.magic, MAP_BINARY_MAGIC, sizeof(header.magic));
+        header.version        = opt.tiled ? MAP_TILED_VERSION : MAP_BINARY_VERSION;
+        header.rows           = opt.rows;
+        header.cols           = opt.cols;
+        header.total_num_gold = opt.gold;
+        fwrite(&header, sizeof(header), 1, out);
+    } else {
+        fprintf(out, "%u\n", opt.gold);
+    }
+
+    // each wave generates one band per thread, then writes them out in order
+    unsigned int             bands = (opt.rows + BAND_ROWS - 1) / BAND_ROWS;
+    std::vector<std::string> buffers(opt.threads);
+    for (unsigned int first = 0; first < bands; first += opt.threads) {
+        unsigned int             wave = std::min(opt.threads, bands - first);
+        std::vector<std::thread> workers;
+        for (unsigned int t = 0; t < wave; ++t) {
+            workers.emplace_back(generate_band, std::cref(opt), first + t,
+                                 std::ref(buffers[t]));
+        }
+        for (unsigned int t = 0; t < wave; ++t) {
+            workers[t].join();
+            if (fwrite(buffers[t].data(), 1, buffers[t].size(), out) !=
+                buffers[t].size()) {
+                perror("ERROR: failed writing map");
+                return 1;
+            }
+        }
+    }
+
+    if (out != stdout) { fclose(out); }
+    return 0;
+}
@@ -10,13 +10,18 @@
  *
  */
 
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <random>
+#include <vector>
 
 #include "error_handler.h"
 #include "goldchase.h"
+#include "map_format.h"
 #include "map_parser.h"
+#include "map_validator.h"
+#include "mine_entrance.h"
 
 Map_parser::Map_parser(std::string path_to_map_file) {
     std::string l;
@@ -24,6 +29,9 @@ Map_parser::Map_parser(std::string path_to_map_file) {
     char        first_line_legal_chars[] = {' ', '\n', '1', '2', '3', '4',
                                      '5', '6',  '7', '8', '9', '0'};
 
+    // binary maps (see map_format.h) carry their size in a fixed header
+    if (parse_binary_header(path_to_map_file)) { return; }
+
     // open file and set class attributes
     std::ifstream fs(path_to_map_file);
 
@@ -72,6 +80,42 @@ Map_parser::Map_parser(std::string path_to_map_file) {
     }
 }
 
+/**
+ * @brief read the header of a binary map file.
+ *
+ * @param path_to_map_file path to map file.
+ * @return true if the file is a binary map (is_good_ tells if it was valid).
+ * @return false if the file is not a binary map.
+ */
+bool Map_parser::parse_binary_header(std::string path_to_map_file) {
+    map_binary_header_S header;
+
+    std::ifstream fs(path_to_map_file, std::ios::binary);
+    if (!fs.read((char *)&header, sizeof(header)) ||
+        (std::memcmp(header.magic, MAP_BINARY_MAGIC, sizeof(header.magic)) != 0)) {
+        return false;
+    }
+
+    is_binary_ = true;
+    // the game segment stores rows/cols as unsigned short, larger worlds can't be
+    // played (mine_bench world reads them a chunk at a time)
+    if (((header.version != MAP_BINARY_VERSION) && (header.version != MAP_TILED_VERSION)) ||
+        (header.total_num_gold == 0) || (header.rows > 0xFFFF) || (header.cols > 0xFFFF)) {
+        handle_error(error_illegal_charecter_in_map_file);
+        is_good_ = false;
+        return true;
+    }
+
+    rows             = header.rows;
+    columns          = header.cols;
+    total_gold_count = header.total_num_gold;
+    fools_gold_count = total_gold_count - REAL_GOLD_COUNT;
+    map_file_path    = path_to_map_file;
+    is_tiled_        = (header.version == MAP_TILED_VERSION);
+    is_good_         = true;
+    return true;
+}
+
 Map_parser::~Map_parser() {}
 bool         Map_parser::is_good() { return is_good_; }
 unsigned int Map_parser::get_rows() { return rows; }
@@ -87,11 +131,54 @@ unsigned int Map_parser::get_random_number() {
     return uni(rng);
 }
 
-void Map_parser::slurp_map(goldMine_S *gmp) {
+/**
+ * @brief clear the planes and set the walls from the map file. Short lines are
+ *          padded with empty cells.
+ *
+ * @param planes map planes of rows x cols cells.
+ */
+void Map_parser::load_walls(Cell_planes &planes) {
     std::string l;
     int         current_position_abs;
 
     is_good_ = false;
+    planes.clear();
+
+    if (is_tiled_) {
+        // a whole row of tiles at a time, tile by tile
+        std::ifstream         fs(map_file_path, std::ios::binary);
+        unsigned int          across = (columns + MAP_TILE_SIDE - 1) / MAP_TILE_SIDE;
+        std::vector<uint64_t> tiles(across * MAP_TILE_SIDE);
+        fs.seekg(sizeof(map_binary_header_S));
+        for (unsigned int y0 = 0; y0 < rows; y0 += MAP_TILE_SIDE) {
+            if (!fs.read((char *)tiles.data(), tiles.size() * sizeof(uint64_t))) { return; }
+            for (unsigned int t = 0; t < across; ++t) {
+                for (unsigned int r = 0; (r < MAP_TILE_SIDE) && (y0 + r < rows); ++r) {
+                    uint64_t     word = tiles[t * MAP_TILE_SIDE + r];
+                    unsigned int x0   = t * MAP_TILE_SIDE;
+                    for (unsigned int c = 0; (c < MAP_TILE_SIDE) && (x0 + c < columns); ++c) {
+                        if ((word >> c) & 1) { planes.set_wall((y0 + r) * columns + x0 + c); }
+                    }
+                }
+            }
+        }
+        is_good_ = true;
+        return;
+    }
+
+    if (is_binary_) {
+        std::ifstream              fs(map_file_path, std::ios::binary);
+        std::vector<unsigned char> row(columns);
+        fs.seekg(sizeof(map_binary_header_S));
+        for (unsigned int y = 0; y < rows; ++y) {
+            if (!fs.read((char *)row.data(), columns)) { return; }
+            for (unsigned int x = 0; x < columns; ++x) {
+                if (row[x] & G_WALL) { planes.set_wall(y * columns + x); }
+            }
+        }
+        is_good_ = true;
+        return;
+    }
 
     // open file and set class attributes
     std::ifstream fs(map_file_path);
@@ -105,43 +192,87 @@ void Map_parser::slurp_map(goldMine_S *gmp) {
             getline(fs, l);
             for (int cur_col = 0; cur_col < columns; ++cur_col) {
                 current_position_abs = cur_row * columns + cur_col;
-                if (l[cur_col] == ' ') {
-                    gmp->map[current_position_abs] = 0;
-                } else if (l[cur_col] == '*') {
-                    gmp->map[current_position_abs] = G_WALL;
+                if ((cur_col < l.length()) && (l[cur_col] == '*')) {
+                    planes.set_wall(current_position_abs);
                 }
             }
         }
         // close file
         fs.close();
 
-        if (total_gold_count > 0) {
+        is_good_ = true;
+    } else {
+        is_good_ = false;
+    }
+}
+
+/**
+ * @brief place real and fool's gold randomly in empty cells of the playable
+ *          component, so every gold can be reached and carried off the map.
+ *
+ * @param planes map planes with walls already loaded.
+ * @param validator connectivity labels of the loaded walls.
+ */
+void Map_parser::place_gold(Cell_planes &planes, const Map_validator &validator) {
+    if (total_gold_count > 0) {
+        // place real gold randomly in empty spaces in map
+        place_gold_piece(planes, validator, G_GOLD);
 
-            // place real gold randomly in empty spaces in map
-            while (1) {
-                unsigned int r = get_random_number();
-                if (gmp->map[r] == 0) {
-                    gmp->map[r] = G_GOLD;
-                    break;
-                }
-            }
+        // place fool's gold randomly in empty spaces in map
+        for (unsigned int i = 0; i < fools_gold_count; ++i) {
+            place_gold_piece(planes, validator, G_FOOL);
+        }
+    }
+}
 
-            // place fool's gold randomly in empty spaces in map
-            int i = 0;
-            while (i < fools_gold_count) {
-                while (1) {
-                    unsigned int r = get_random_number();
-                    if (gmp->map[r] == 0) {
-                        gmp->map[r] = G_FOOL;
-                        break;
-                    }
-                }
-                ++i;
-            }
+/**
+ * @brief put one piece of gold on a random empty cell the players can reach. Used
+ *          for the map's gold and for gold put back during a game, so the caller
+ *          makes sure there is room: an empty playable cell and a free slot in the
+ *          gold set, see Cell_planes::compact_gold().
+ *
+ * @param planes map planes, walls loaded.
+ * @param validator connectivity of the same map.
+ * @param kind G_GOLD or G_FOOL.
+ * @return unsigned int the cell the gold was put on.
+ */
+unsigned int place_gold_piece(Cell_planes &planes, const Map_validator &validator,
+                              unsigned char kind) {
+    static std::mt19937                         rng(std::random_device{}());
+    std::uniform_int_distribution<unsigned int> uni(0, planes.get_cells() - 1);
+
+    while (1) {
+        unsigned int r = uni(rng);
+        if (validator.is_playable(r) && (planes.players(r) == 0) && planes.add_gold(r, kind)) {
+            return r;
         }
+    }
+}
 
-        is_good_ = true;
-    } else {
+/**
+ * @brief load the walls, validate connectivity and place the gold.
+ *
+ * @param planes map planes of rows x cols cells.
+ */
+void Map_parser::slurp_map(Cell_planes &planes) {
+    if (total_gold_count > GOLD_SET_MAX) {
+        handle_error(error_map_too_much_gold);
         is_good_ = false;
+        return;
     }
-}
\ No newline at end of file
+
+    load_walls(planes);
+    if (!is_good_) { return; }
+
+    Map_validator validator(planes);
+
+    // the playable component must fit all gold plus a full house of players
+    if (!validator.is_good() ||
+        (validator.get_playable_size() < total_gold_count + MAX_NUM_PLAYERS)) {
+        handle_error(error_map_gold_not_reachable);
+        is_good_ = false;
+        return;
+    }
+
+    place_gold(planes, validator);
+}
@@ -3,7 +3,8 @@
 
 #include <string>
 
-#include "mine_entrance.h"
+#include "cell_planes.h"
+#include "map_validator.h"
 
 #define REAL_GOLD_COUNT 1
 
@@ -15,6 +16,10 @@ class Map_parser {
     unsigned int columns          = 0;
     std::string  map_file_path    = "";
     bool         is_good_         = false;
+    bool         is_binary_       = false;
+    bool         is_tiled_        = false; // MAP_TILED_VERSION, see map_format.h
+
+    bool parse_binary_header(std::string path_to_map_file);
 
   public:
     Map_parser(std::string path_to_map_file);
@@ -25,7 +30,12 @@ class Map_parser {
     unsigned int get_count_of_total_gold();
     unsigned int get_count_of_fools_gold();
     unsigned int get_random_number();
-    void         slurp_map(goldMine_S *gmp);
+    void         load_walls(Cell_planes &planes);
+    void         place_gold(Cell_planes &planes, const Map_validator &validator);
+    void         slurp_map(Cell_planes &planes);
 };
 
+unsigned int place_gold_piece(Cell_planes &planes, const Map_validator &validator,
+                              unsigned char kind);
+
 #endif // __MAP_PARSER_H__
\ No newline at end of file
@@ -0,0 +1,115 @@
+/**
+ * @file map_validator.cpp
+ * @author Feras Alshehri (falshehri@mail.csuchico.edu)
+ * @brief connectivity check of a parsed map so gold and players are only ever
+ *          placed where the game can actually be finished.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "goldchase.h"
+#include "map_validator.h"
+
+/**
+ * @brief label every open cell with its component and pick the playable one.
+ *
+ * @param planes map planes, only walls are looked at.
+ */
+Map_validator::Map_validator(const Cell_planes &planes)
+    : rows(planes.get_rows()), cols(planes.get_cols()) {
+    labels.assign(rows * cols, 0);
+    component_size.push_back(0); // label 0 is reserved for walls
+    touches_edge.push_back(false);
+
+    for (unsigned int i = 0; i < rows * cols; ++i) {
+        if (labels[i] == 0 && !planes.is_wall(i)) {
+            component_size.push_back(0);
+            touches_edge.push_back(false);
+            fill(i, component_size.size() - 1, planes);
+        }
+    }
+
+    for (unsigned int l = 1; l < component_size.size(); ++l) {
+        if (touches_edge[l] && component_size[l] > component_size[playable]) {
+            playable = l;
+        }
+    }
+}
+
+Map_validator::~Map_validator() {}
+
+/**
+ * @brief scanline flood fill: every popped seed is widened into a full horizontal
+ *          span, then the rows above and below are scanned once for new spans.
+ *          This touches each cell a constant number of times and keeps the
+ *          explicit stack small compared to a per-cell fill.
+ *
+ * @param seed first cell of the component.
+ * @param label label to give the component.
+ * @param planes map planes.
+ */
+void Map_validator::fill(unsigned int seed, unsigned int label, const Cell_planes &planes) {
+    std::vector<unsigned int> stack;
+    stack.push_back(seed);
+
+    auto open = [&](unsigned int cell) {
+        return labels[cell] == 0 && !planes.is_wall(cell);
+    };
+
+    while (!stack.empty()) {
+        unsigned int cell = stack.back();
+        stack.pop_back();
+        if (!open(cell)) { continue; }
+
+        unsigned int y     = cell / cols;
+        unsigned int row   = y * cols;
+        unsigned int left  = cell % cols;
+        unsigned int right = left;
+
+        // widen the seed into the whole open span on this row
+        while (left > 0 && open(row + left - 1)) { --left; }
+        while (right + 1 < cols && open(row + right + 1)) { ++right; }
+
+        for (unsigned int x = left; x <= right; ++x) { labels[row + x] = label; }
+        component_size[label] += right - left + 1;
+        if (y == 0 || y == rows - 1 || left == 0 || right == cols - 1) {
+            touches_edge[label] = true;
+        }
+
+        // push one seed per open run in the neighbouring rows
+        for (int dy = -1; dy <= 1; dy += 2) {
+            if ((dy < 0 && y == 0) || (dy > 0 && y + 1 == rows)) { continue; }
+            unsigned int nrow    = (y + dy) * cols;
+            bool         in_span = false;
+            for (unsigned int x = left; x <= right; ++x) {
+                bool o = open(nrow + x);
+                if (o && !in_span) { stack.push_back(nrow + x); }
+                in_span = o;
+            }
+        }
+    }
+}
+
+bool Map_validator::is_good() { return playable != 0; }
+
+/**
+ * @brief is the cell part of the component that touches the map edge.
+ *
+ * @param cell map cell index.
+ */
+bool Map_validator::is_playable(unsigned int cell) const {
+    return playable != 0 && labels[cell] == playable;
+}
+
+unsigned int Map_validator::get_component_count() { return component_size.size() - 1; }
+
+unsigned int Map_validator::get_edge_component_count() {
+    unsigned int count = 0;
+    for (unsigned int l = 1; l < touches_edge.size(); ++l) { count += touches_edge[l]; }
+    return count;
+}
+
+unsigned int Map_validator::get_playable_size() { return component_size[playable]; }
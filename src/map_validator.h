@@ -0,0 +1,34 @@
+#ifndef __MAP_VALIDATOR_H__
+#define __MAP_VALIDATOR_H__
+
+#include <vector>
+
+#include "cell_planes.h"
+
+/**
+ * @brief labels the connected components of open (non wall) cells with a scanline
+ *          flood fill. The playable component is the largest one that touches the
+ *          edge of the map, since a player has to walk off the map to win.
+ */
+class Map_validator {
+  private:
+    unsigned int              rows     = 0;
+    unsigned int              cols     = 0;
+    unsigned int              playable = 0; // label of the playable component
+    std::vector<unsigned int> labels;       // per cell, 0 = wall
+    std::vector<unsigned int> component_size;
+    std::vector<bool>         touches_edge;
+
+    void fill(unsigned int seed, unsigned int label, const Cell_planes &planes);
+
+  public:
+    Map_validator(const Cell_planes &planes);
+    ~Map_validator();
+    bool         is_good();
+    bool         is_playable(unsigned int cell) const;
+    unsigned int get_component_count();
+    unsigned int get_edge_component_count();
+    unsigned int get_playable_size();
+};
+
+#endif // __MAP_VALIDATOR_H__
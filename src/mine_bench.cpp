@@ -0,0 +1,1526 @@
+/**
+ * @file mine_bench.cpp
+ * @author Feras Alshehri (falshehri@mail.csuchico.edu)
+ * @brief headless benchmarks for the game's hot paths. Each benchmark is a
+ *          subcommand, e.g. "./mine_bench paths 4096 4096".
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <pty.h>
+#include <queue>
+#include <sched.h>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "Map.h"
+#include "cell_planes.h"
+#include "cell_scan.h"
+#include "event_loop.h"
+#include "field_of_view.h"
+#include "game_log.h"
+#include "game_session.h"
+#include "goldchase.h"
+#include "map_format.h"
+#include "map_parser.h"
+#include "map_validator.h"
+#include "mine_entrance.h"
+#include "move_journal.h"
+#include "move_kernel.h"
+#include "path_finder.h"
+#include "player_messaging.h"
+#include "shm_arena.h"
+#include "spatial_index.h"
+#include "timer_wheel.h"
+
+#define BENCH_WORLD_AHEAD 3 // rows of chunks ahead of the walker read ahead, see world_visit()
+
+typedef std::chrono::steady_clock bench_clock;
+
+/**
+ * @brief seconds elapsed since start.
+ *
+ * @param start time point taken with bench_clock::now().
+ * @return double elapsed seconds.
+ */
+static double seconds_since(bench_clock::time_point start) {
+    return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+/**
+ * @brief small deterministic PRNG so runs are repeatable across builds.
+ *
+ * @param state generator state, updated in place.
+ * @return uint32_t next pseudo random number.
+ */
+static uint32_t xorshift32(uint32_t &state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+/**
+ * @brief fill a rows*cols map with scattered walls and some gold.
+ *
+ * @param map output map, resized to rows*cols.
+ * @param rows number of rows.
+ * @param cols number of cols.
+ * @param gold number of gold cells to place.
+ */
+static void make_synthetic_map(std::vector<unsigned char> &map, unsigned int rows,
+                               unsigned int cols, unsigned int gold) {
+    uint32_t seed = 0x9e3779b9;
+
+    map.assign(rows * cols, 0);
+    for (auto &cell : map) {
+        if ((xorshift32(seed) & 3) == 0) { cell = G_WALL; }
+    }
+    while (gold > 0) {
+        unsigned int r = xorshift32(seed) % (rows * cols);
+        if (map[r] == 0) {
+            map[r] = (gold == 1) ? G_GOLD : G_FOOL;
+            --gold;
+        }
+    }
+}
+
+/**
+ * @brief load a map in the single byte per cell encoding into planes of the same
+ *          size.
+ *
+ * @param planes planes to fill, cleared first.
+ * @param map rows*cols map.
+ */
+static void load_planes(Cell_planes &planes, const std::vector<unsigned char> &map) {
+    planes.clear();
+    for (unsigned int i = 0; i < map.size(); ++i) {
+        if (map[i] == G_WALL) {
+            planes.set_wall(i);
+        } else if (map[i] & (G_GOLD | G_FOOL)) {
+            planes.add_gold(i, map[i]);
+        } else {
+            planes.set_players(i, map[i]);
+        }
+    }
+}
+
+/**
+ * @brief full rebuild, incremental gold add and next-step query throughput of the
+ *          BFS distance field.
+ *
+ * usage: paths [rows] [cols]
+ */
+static int bench_paths(int argc, char *argv[]) {
+    unsigned int rows = (argc > 2) ? std::stoul(argv[2]) : 4096;
+    unsigned int cols = (argc > 3) ? std::stoul(argv[3]) : 4096;
+
+    std::vector<unsigned char> map;
+    Cell_planes_buffer         buf(rows, cols);
+    make_synthetic_map(map, rows, cols, 64);
+    load_planes(buf.planes(), map);
+
+    auto        start = bench_clock::now();
+    Path_finder finder(buf.planes());
+    double      t_build = seconds_since(start);
+
+    start = bench_clock::now();
+    finder.rebuild(buf.planes());
+    double t_rebuild = seconds_since(start);
+
+    // incremental adds: drop a few new fool's gold and let the field relax
+    uint32_t     seed  = 12345;
+    unsigned int added = 0;
+    start              = bench_clock::now();
+    while (added < 16) {
+        unsigned int r = xorshift32(seed) % (rows * cols);
+        if (map[r] == 0) {
+            map[r] = G_FOOL;
+            finder.add_gold(r);
+            ++added;
+        }
+    }
+    double t_add = seconds_since(start) / added;
+
+    // next step queries from random cells
+    const unsigned int     queries = 10000000;
+    volatile unsigned long sink    = 0; // keeps the queries from being optimized out
+    start                          = bench_clock::now();
+    for (unsigned int i = 0; i < queries; ++i) {
+        sink = sink + finder.next_key(xorshift32(seed) % (rows * cols));
+    }
+    double t_query = seconds_since(start);
+
+    std::cout << "paths " << rows << "x" << cols << "\n";
+    std::cout << "  construct + build : " << t_build * 1e3 << " ms\n";
+    std::cout << "  full rebuild      : " << t_rebuild * 1e3 << " ms ("
+              << (rows * cols) / t_rebuild / 1e6 << " Mcells/s)\n";
+    std::cout << "  incremental add   : " << t_add * 1e3 << " ms/gold\n";
+    std::cout << "  next_key query    : " << t_query / queries * 1e9 << " ns\n";
+    return 0;
+}
+
+/**
+ * @brief send, retrying while the receiver's inbox is full or not created yet.
+ */
+static void send_until_accepted(Player_messaging &endpoint, unsigned int to,
+                                const std::string &text) {
+    while (!endpoint.send(to, text)) { sched_yield(); }
+}
+
+/**
+ * @brief one player's side of the messaging benchmark. Player 1 measures, player 2
+ *          echoes every ping and acknowledges the end of the stream.
+ *
+ * @param transport transport under test.
+ * @param rings anonymous shared mapping standing in for the game segment.
+ * @param player 1 or 2.
+ * @param count number of round trips, and number of streamed messages.
+ * @param ready pipe player 2 reports on once its inbox exists.
+ */
+static void msg_endpoint(MESSAGE_TRANSPORT_E transport, message_rings_S *rings,
+                         unsigned int player, unsigned int count, int ready[2]) {
+    Player_messaging endpoint(transport, rings, player, "/goldchase_bench_mq");
+    std::string      text(64, 'x');
+    message_S        msg;
+    char             byte = 0;
+
+    if (player == 2) {
+        if (write(ready[1], &byte, 1) != 1) { _exit(1); }
+        for (unsigned int i = 0; i < count; ++i) {
+            while (!endpoint.receive(msg, 1000)) {}
+            send_until_accepted(endpoint, 1, text);
+        }
+        for (unsigned int i = 0; i < count; ++i) {
+            while (!endpoint.receive(msg, 1000)) {}
+        }
+        send_until_accepted(endpoint, 1, "done");
+        return;
+    }
+
+    if (read(ready[0], &byte, 1) != 1) { return; }
+
+    auto start = bench_clock::now();
+    for (unsigned int i = 0; i < count; ++i) {
+        send_until_accepted(endpoint, 2, text);
+        while (!endpoint.receive(msg, 1000)) {}
+    }
+    double t_pingpong = seconds_since(start);
+
+    start = bench_clock::now();
+    for (unsigned int i = 0; i < count; ++i) { send_until_accepted(endpoint, 2, text); }
+    while (!endpoint.receive(msg, 1000)) {}
+    double t_stream = seconds_since(start);
+
+    std::cout << "  " << (transport == transport_mq ? "mq  " : "ring")
+              << "  one-way latency : " << t_pingpong / count / 2 * 1e6 << " us"
+              << ", throughput : " << count / t_stream / 1e3 << " kmsg/s\n";
+}
+
+/**
+ * @brief latency (ping-pong) and throughput (one way stream) of player messages
+ *          between two processes, over POSIX message queues and over the shared
+ *          memory rings.
+ *
+ * usage: msg [count]
+ */
+static int bench_msg(int argc, char *argv[]) {
+    unsigned int count = (argc > 2) ? std::stoul(argv[2]) : 100000;
+
+    std::cout << "msg " << count << " messages of " << sizeof(message_S) << " bytes\n";
+    for (MESSAGE_TRANSPORT_E transport : {transport_mq, transport_ring}) {
+        void *mem = mmap(nullptr, sizeof(message_rings_S), PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        int   ready[2];
+        if ((mem == MAP_FAILED) || (pipe(ready) == -1)) {
+            perror("msg");
+            return 1;
+        }
+        message_rings_S *rings = new (mem) message_rings_S();
+
+        std::cout.flush();
+        pid_t pid = fork();
+        if (pid == 0) {
+            msg_endpoint(transport, rings, 2, count, ready);
+            _exit(0);
+        }
+        msg_endpoint(transport, rings, 1, count, ready);
+        waitpid(pid, nullptr, 0);
+
+        close(ready[0]);
+        close(ready[1]);
+        munmap(mem, sizeof(message_rings_S));
+    }
+    return 0;
+}
+
+/**
+ * @brief straightforward move rules, the specification move_kernel() is checked
+ *          against: signed row/col arithmetic, direction known only at run time.
+ */
+static move_result_S move_reference(const unsigned char *map, int rows, int cols,
+                                    unsigned int cell, int dr, int dc, bool has_gold) {
+    int             row  = cell / cols;
+    int             col  = cell % cols;
+    move_position_S from = {(unsigned int)row, (unsigned int)col, cell};
+
+    for (int k = 1; k <= 2; ++k) {
+        int r = row + k * dr;
+        int c = col + k * dc;
+        if ((r < 0) || (r >= rows) || (c < 0) || (c >= cols)) {
+            return {has_gold ? move_exit : move_off_map, from};
+        }
+        move_position_S target = {(unsigned int)r, (unsigned int)c, (unsigned int)(r * cols + c)};
+        unsigned char   v      = map[target.cell];
+        if (v & G_ANYP) {
+            if (k == 2) { return {move_blocked, from}; }
+            continue; // go over player
+        }
+        if (v == 0) { return {move_ok, target}; }
+        if (v == G_GOLD) { return {move_found_gold, target}; }
+        if (v == G_FOOL) { return {move_found_fools_gold, target}; }
+        return {move_blocked, from};
+    }
+    return {move_blocked, from};
+}
+
+/**
+ * @brief check every kernel against move_reference() from every cell of small maps,
+ *          with every combination of contents in the two cells ahead, then time both
+ *          on a random walk over a large map.
+ *
+ * usage: moves [count]
+ */
+static int bench_moves(int argc, char *argv[]) {
+    static const int     dr[dir_count]      = {0, 1, -1, 0, -1, -1, 1, 1};
+    static const int     dc[dir_count]      = {-1, 0, 0, 1, -1, 1, -1, 1};
+    static const uint8_t contents[]         = {0, G_WALL, G_GOLD, G_FOOL, G_PLR1};
+    const unsigned int   n_contents         = sizeof(contents);
+    unsigned int         count              = (argc > 2) ? std::stoul(argv[2]) : 50000000;
+    unsigned long        checked = 0, wrong = 0;
+
+    // exhaustive: sizes cover 1 wide/high maps, where every cell is on an edge
+    for (unsigned int rows = 1; rows <= 5; ++rows) {
+        for (unsigned int cols = 1; cols <= 5; ++cols) {
+            std::vector<unsigned char> map(rows * cols);
+            Cell_planes_buffer         buf(rows, cols);
+            for (unsigned int cell = 0; cell < rows * cols; ++cell) {
+                for (unsigned int d = 0; d < dir_count; ++d) {
+                    int r1 = cell / cols + dr[d], c1 = cell % cols + dc[d];
+                    int r2 = r1 + dr[d], c2 = c1 + dc[d];
+                    for (unsigned int a = 0; a < n_contents * n_contents * 2; ++a) {
+                        std::fill(map.begin(), map.end(), 0);
+                        map[cell] = G_PLR0;
+                        if ((r1 >= 0) && (r1 < (int)rows) && (c1 >= 0) && (c1 < (int)cols)) {
+                            map[r1 * cols + c1] = contents[a % n_contents];
+                        }
+                        if ((r2 >= 0) && (r2 < (int)rows) && (c2 >= 0) && (c2 < (int)cols)) {
+                            map[r2 * cols + c2] = contents[a / n_contents % n_contents];
+                        }
+                        bool          has_gold = a >= n_contents * n_contents;
+                        move_result_S want = move_reference(map.data(), rows, cols, cell,
+                                                            dr[d], dc[d], has_gold);
+                        move_position_S from = {cell / cols, cell % cols, cell};
+                        load_planes(buf.planes(), map);
+                        move_result_S got = move_dispatch((DIRECTION_E)d, buf.planes(), from,
+                                                          has_gold);
+                        ++checked;
+                        if ((got.outcome != want.outcome) ||
+                            (got.target.row != want.target.row) ||
+                            (got.target.col != want.target.col) ||
+                            (got.target.cell != want.target.cell)) {
+                            if (wrong++ < 10) {
+                                std::cout << "  MISMATCH " << rows << "x" << cols
+                                          << " cell " << cell << " dir " << d << "\n";
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // throughput: random walk on a large synthetic map
+    const unsigned int         rows = 1024, cols = 1024;
+    std::vector<unsigned char> map;
+    make_synthetic_map(map, rows, cols, 64);
+    std::vector<unsigned char> dirs(count);
+    uint32_t                   seed = 777;
+    for (unsigned int i = 0; i < count; ++i) {
+        dirs[i] = (i % 8 == 0) ? xorshift32(seed) % dir_count : dirs[i - 1];
+    }
+
+    volatile unsigned long sink = 0;
+    unsigned int           cell = rows / 2 * cols + cols / 2;
+    map[cell]                   = 0;
+    Cell_planes_buffer walk(rows, cols);
+    load_planes(walk.planes(), map);
+    auto start                  = bench_clock::now();
+    for (unsigned int i = 0; i < count; ++i) {
+        move_result_S res = move_reference(map.data(), rows, cols, cell, dr[dirs[i]],
+                                           dc[dirs[i]], false);
+        if (res.outcome == move_ok) { cell = res.target.cell; }
+        sink = sink + res.outcome;
+    }
+    double t_reference = seconds_since(start);
+
+    move_position_S pos = {rows / 2, cols / 2, rows / 2 * cols + cols / 2};
+    start               = bench_clock::now();
+    for (unsigned int i = 0; i < count; ++i) {
+        move_result_S res = move_dispatch((DIRECTION_E)dirs[i], walk.planes(), pos, false);
+        if (res.outcome == move_ok) { pos = res.target; }
+        sink = sink + res.outcome;
+    }
+    double t_kernel = seconds_since(start);
+
+    // what controller() paid per key before: find the player by scanning the map
+    unsigned int scanned = count / 50000;
+    map[pos.cell]        = G_PLR0;
+    start                = bench_clock::now();
+    for (unsigned int i = 0; i < scanned; ++i) {
+        unsigned int here = 0;
+        while (map[here] != G_PLR0) { ++here; }
+        move_result_S res = move_reference(map.data(), rows, cols, here, dr[dirs[i]],
+                                           dc[dirs[i]], false);
+        if (res.outcome == move_ok) {
+            map[here]            = 0;
+            map[res.target.cell] = G_PLR0;
+        }
+    }
+    double t_scan = seconds_since(start);
+
+    std::cout << "moves\n";
+    std::cout << "  exhaustive check  : " << checked << " cases, " << wrong
+              << " mismatches\n";
+    std::cout << "  reference         : " << t_reference / count * 1e9 << " ns/move\n";
+    std::cout << "  kernel            : " << t_kernel / count * 1e9 << " ns/move\n";
+    std::cout << "  scan + reference  : " << t_scan / scanned * 1e6
+              << " us/move (old controller, " << rows << "x" << cols << " map)\n";
+    return (wrong == 0) ? 0 : 1;
+}
+
+/**
+ * @brief headless games between MAX_NUM_PLAYERS bots, through the same modules a
+ *          real game uses: the map is parsed, validated and gets its gold placed,
+ *          bots follow the path finder's hint with the move kernels, and every
+ *          move is journaled. Also the training workload of "make pgo".
+ *
+ * usage: bot <map file> [games]
+ */
+static int bench_bot(int argc, char *argv[]) {
+    if (argc < 3) {
+        std::cerr << "usage: mine_bench bot <map file> [games]\n";
+        return 1;
+    }
+    unsigned int games = (argc > 3) ? std::stoul(argv[3]) : 100;
+
+    Map_parser parser(argv[2]);
+    if (!parser.is_good()) {
+        std::cerr << "ERROR: " << argv[2] << " is not a valid map\n";
+        return 1;
+    }
+    unsigned int       rows   = parser.get_rows();
+    unsigned int       cols   = parser.get_cols();
+    unsigned int       cells  = rows * cols;
+    Cell_planes_buffer buf(rows, cols);
+    Cell_planes       &planes = buf.planes();
+
+    std::string  journal_path = "/tmp/goldchase_bench_journal." + std::to_string(getpid());
+    Move_journal journal;
+    journal.create(journal_path, rows, cols, 1u << 16);
+
+    uint32_t     seed  = 2022;
+    uint64_t     moves = 0;
+    double       t_setup = 0, t_play = 0;
+    Path_finder *finder  = nullptr;
+    for (unsigned int game = 0; game < games; ++game) {
+        auto start = bench_clock::now();
+        parser.slurp_map(planes);
+        if (!parser.is_good()) {
+            std::cerr << "ERROR: not enough reachable room for the gold\n";
+            return 1;
+        }
+        if (finder == nullptr) {
+            finder = new Path_finder(planes);
+        } else {
+            finder->rebuild(planes);
+        }
+
+        Map_validator   validator(planes);
+        move_position_S bots[MAX_NUM_PLAYERS];
+        for (unsigned int b = 0; b < MAX_NUM_PLAYERS; ++b) {
+            unsigned int r;
+            do { r = xorshift32(seed) % cells; } while ((planes.cell_value(r) != 0) ||
+                                                       !validator.is_playable(r));
+            planes.set_players(r, G_PLR0 << b);
+            bots[b]     = {r / cols, r % cols, r};
+        }
+        t_setup += seconds_since(start);
+
+        // bots take turns until one picks up the real gold; a bot that can't follow
+        // its hint (another bot in the way) tries a random direction instead
+        start          = bench_clock::now();
+        bool     won   = false;
+        uint64_t turns = 0;
+        while (!won && (turns < 64ull * cells)) {
+            unsigned int   b         = turns++ % MAX_NUM_PLAYERS;
+            unsigned char  mask      = G_PLR0 << b;
+            DIRECTION_E    direction = direction_of_key(finder->next_key(bots[b].cell));
+            if ((direction == dir_none) || ((xorshift32(seed) & 7) == 0)) {
+                direction = (DIRECTION_E)(xorshift32(seed) % dir_count);
+            }
+
+            move_result_S res = move_dispatch(direction, planes, bots[b], false);
+            if (res.outcome >= move_blocked) { continue; }
+
+            journal.record(journal_move, mask, bots[b].cell, res.target.cell,
+                           planes.take_gold(res.target.cell));
+            planes.set_players(bots[b].cell, 0);
+            planes.set_players(res.target.cell, mask);
+            bots[b]                   = res.target;
+            ++moves;
+            if (res.outcome == move_found_fools_gold) { finder->remove_gold(res.target.cell); }
+            won = (res.outcome == move_found_gold);
+        }
+        t_play += seconds_since(start);
+    }
+    delete finder;
+    journal.close();
+    unlink(journal_path.c_str());
+
+    std::cout << "bot " << rows << "x" << cols << ", " << games << " games\n";
+    std::cout << "  setup             : " << t_setup / games * 1e3 << " ms/game\n";
+    std::cout << "  play              : " << t_play / games * 1e3 << " ms/game, "
+              << moves / t_play / 1e6 << " Mmoves/s\n";
+    std::cout << "  total             : " << (t_setup + t_play) * 1e3 << " ms\n";
+    return 0;
+}
+
+/**
+ * @brief radius queries through the spatial index against scanning the same square
+ *          of cells, and against scanning the whole map as finding players used to.
+ *          Every query is checked to find the same number of entities both ways.
+ *          Then queries over the whole map, which walk the index rather than every
+ *          bucket the map has.
+ *
+ * usage: spatial [queries] [radius] [entities]
+ */
+static int bench_spatial(int argc, char *argv[]) {
+    unsigned int       queries  = (argc > 2) ? std::stoul(argv[2]) : 1000000;
+    unsigned int       radius   = (argc > 3) ? std::stoul(argv[3]) : 5;
+    unsigned int       entities = (argc > 4) ? std::stoul(argv[4]) : 4096;
+    const unsigned int rows = 1024, cols = 1024, cells = rows * cols;
+    const unsigned char kinds = G_ANYP | G_GOLD | G_FOOL;
+
+    // players, then gold, more of it than a game's gold set holds
+    std::vector<unsigned char> map(cells, 0);
+    uint32_t                   seed = 4242;
+    for (unsigned int n = 0; n < std::min(entities, cells / 2); ++n) {
+        unsigned int r;
+        do { r = xorshift32(seed) % cells; } while (map[r] != 0);
+        map[r] = (n < SPATIAL_MAX_PLAYERS) ? G_PLR0 << n : ((n & 7) ? G_FOOL : G_GOLD);
+    }
+    std::vector<char> storage(spatial_index_bytes(entities));
+    Spatial_index     index((spatial_index_S *)storage.data(), rows, cols);
+    index.format(entities);
+    for (unsigned int c = 0; c < cells; ++c) {
+        if (map[c] != 0) { index.insert(c, map[c]); }
+    }
+
+    std::vector<unsigned int> centers(queries);
+    for (auto &c : centers) { c = xorshift32(seed) % cells; }
+
+    std::vector<spatial_entity_S> found;
+    std::vector<unsigned int>     expected(queries);
+    uint64_t                      hits = 0;
+    auto                          start = bench_clock::now();
+    for (unsigned int i = 0; i < queries; ++i) {
+        found.clear();
+        index.query_radius(centers[i], radius, kinds, found);
+        expected[i] = found.size();
+        hits += found.size();
+    }
+    double t_index = seconds_since(start);
+
+    unsigned long wrong = 0;
+    start               = bench_clock::now();
+    for (unsigned int i = 0; i < queries; ++i) {
+        int          row = centers[i] / cols, col = centers[i] % cols;
+        unsigned int n   = 0;
+        for (int r = std::max(row - (int)radius, 0);
+             r <= std::min(row + (int)radius, (int)rows - 1); ++r) {
+            for (int c = std::max(col - (int)radius, 0);
+                 c <= std::min(col + (int)radius, (int)cols - 1); ++c) {
+                n += (map[r * cols + c] & kinds) != 0;
+            }
+        }
+        wrong += (n != expected[i]);
+    }
+    double t_square = seconds_since(start);
+
+    unsigned int full = std::max(queries / 10000, 1u);
+    start             = bench_clock::now();
+    for (unsigned int i = 0; i < full; ++i) {
+        volatile unsigned int n = 0;
+        for (unsigned int c = 0; c < cells; ++c) { n = n + ((map[c] & G_ANYP) != 0); }
+    }
+    double t_full = seconds_since(start);
+
+    start = bench_clock::now();
+    for (unsigned int i = 0; i < full; ++i) {
+        found.clear();
+        index.query_rect(0, 0, rows - 1, cols - 1, kinds, found);
+        wrong += (found.size() != index.get_count());
+    }
+    double t_whole = seconds_since(start);
+
+    // keeping the index current: players wander around
+    unsigned int  updates = queries, moved = 0;
+    unsigned int  at[SPATIAL_MAX_PLAYERS];
+    unsigned char kind[SPATIAL_MAX_PLAYERS];
+    for (unsigned int c = 0, n = 0; n < SPATIAL_MAX_PLAYERS; ++c) {
+        if (map[c] & G_ANYP) {
+            at[n]     = c;
+            kind[n++] = map[c];
+        }
+    }
+    start = bench_clock::now();
+    for (unsigned int i = 0; i < updates; ++i) {
+        unsigned int p  = i % SPATIAL_MAX_PLAYERS;
+        unsigned int to = (at[p] + ((xorshift32(seed) & 2) ? 1 : cols)) % cells;
+        moved += index.move(at[p], to, kind[p]);
+        at[p] = to;
+    }
+    double t_update = seconds_since(start);
+
+    std::cout << "spatial " << rows << "x" << cols << ", " << index.get_count()
+              << " entities, radius " << radius << "\n";
+    std::cout << "  index query       : " << t_index / queries * 1e9 << " ns ("
+              << (double)hits / queries << " found on average)\n";
+    std::cout << "  square scan       : " << t_square / queries * 1e9 << " ns, " << wrong
+              << " mismatches\n";
+    std::cout << "  full map scan     : " << t_full / full * 1e6 << " us\n";
+    std::cout << "  whole map query   : " << t_whole / full * 1e6 << " us\n";
+    std::cout << "  index move        : " << t_update / updates * 1e9 << " ns\n";
+    return ((wrong == 0) && (moved == updates)) ? 0 : 1;
+}
+
+/**
+ * @brief fog of war: shadowcasting from random open cells, first from scratch and
+ *          then out of the cache, and how many cells a frame draws compared with
+ *          drawing the whole map.
+ *
+ * usage: fog <map file> [radius] [positions]
+ */
+static int bench_fog(int argc, char *argv[]) {
+    if (argc < 3) {
+        std::cerr << "usage: mine_bench fog <map file> [radius] [positions]\n";
+        return 1;
+    }
+    unsigned int radius    = (argc > 3) ? std::stoul(argv[3]) : 0;
+    unsigned int positions = (argc > 4) ? std::stoul(argv[4]) : 1000;
+
+    Map_parser parser(argv[2]);
+    if (!parser.is_good()) {
+        std::cerr << "ERROR: " << argv[2] << " is not a valid map\n";
+        return 1;
+    }
+    Cell_planes_buffer buf(parser.get_rows(), parser.get_cols());
+    parser.load_walls(buf.planes());
+    const Cell_planes &planes = buf.planes();
+
+    std::vector<unsigned int> open;
+    for (unsigned int c = 0; c < planes.get_cells(); ++c) {
+        if (!planes.is_wall(c)) { open.push_back(c); }
+    }
+    if (open.empty()) {
+        std::cerr << "ERROR: " << argv[2] << " has no open cells\n";
+        return 1;
+    }
+    uint32_t                  seed = 99;
+    std::vector<unsigned int> cells(positions);
+    for (auto &c : cells) { c = open[xorshift32(seed) % open.size()]; }
+
+    Field_of_view fov(planes, radius);
+    uint64_t      seen  = 0;
+    auto          start = bench_clock::now();
+    for (unsigned int c : cells) { seen += fov.visible_from(c).size(); }
+    double t_cold = seconds_since(start);
+
+    unsigned int rounds = 100;
+    start               = bench_clock::now();
+    for (unsigned int i = 0; i < rounds; ++i) {
+        for (unsigned int c : cells) { seen += fov.visible_from(c).size(); }
+    }
+    double t_warm = seconds_since(start) / rounds;
+
+    double per_frame = (double)seen / (positions * (rounds + 1));
+    std::cout << "fog " << planes.get_rows() << "x" << planes.get_cols() << ", radius "
+              << (radius ? std::to_string(radius) : "unlimited") << "\n";
+    std::cout << "  shadowcast        : " << t_cold / positions * 1e6 << " us/position\n";
+    std::cout << "  cached            : " << t_warm / positions * 1e9 << " ns/position ("
+              << fov.get_cache_size() << " positions cached)\n";
+    std::cout << "  cells per frame   : " << per_frame << " visible, "
+              << planes.get_cells() << " for the whole map\n";
+    return 0;
+}
+
+/**
+ * @brief draw frames of a player walking around, on a pseudo terminal, and report
+ *          what the frames cost in bytes. The child does the drawing and reports
+ *          its own count, the parent counts what arrives on the terminal.
+ *
+ * @param backend Screen backend to draw with.
+ * @param map_file map to walk on.
+ * @param frames number of frames.
+ */
+static void term_walk(Screen::backends backend, const char *map_file, unsigned int frames) {
+    struct winsize ws      = {40, 120, 0, 0};
+    int            report[2];
+    int            master  = -1;
+    uint64_t       arrived = 0;
+
+    if (pipe(report) != 0) { return; }
+    pid_t pid = forkpty(&master, nullptr, nullptr, &ws);
+    if (pid == 0) {
+        close(report[0]);
+        setenv("TERM", "xterm", 1);
+        Map_parser         parser(map_file);
+        Cell_planes_buffer buf(parser.get_rows(), parser.get_cols());
+        Cell_planes       &planes = buf.planes();
+        parser.slurp_map(planes);
+
+        unsigned int cell = 0;
+        while (planes.cell_value(cell) != 0) { ++cell; }
+        planes.set_players(cell, G_PLR0);
+        move_position_S pos = {cell / planes.get_cols(), cell % planes.get_cols(), cell};
+
+        Screen::setBackend(backend);
+        Map     *map  = new Map(planes); // never destroyed, that would wait for a key
+        uint32_t seed = 31;
+        uint64_t before[2] = {map->getBytesWritten(), 0};
+        for (unsigned int f = 0; f < frames; ++f) {
+            move_result_S res =
+                move_dispatch((DIRECTION_E)(xorshift32(seed) % dir_count), planes, pos, false);
+            if (res.outcome <= move_found_fools_gold) {
+                planes.take_gold(res.target.cell);
+                planes.set_players(pos.cell, 0);
+                planes.set_players(res.target.cell, G_PLR0);
+                pos = res.target;
+            }
+            map->drawMap();
+        }
+        before[1] = map->getBytesWritten() - before[0];
+        if (write(report[1], before, sizeof(before)) != sizeof(before)) { _exit(1); }
+        _exit(0);
+    }
+    close(report[1]);
+    if (pid < 0) { return; }
+
+    char    buf[65536];
+    ssize_t n;
+    while ((n = read(master, buf, sizeof(buf))) > 0) { arrived += n; }
+    waitpid(pid, nullptr, 0);
+
+    uint64_t counted[2] = {0, 0};
+    if (read(report[0], counted, sizeof(counted)) != sizeof(counted)) {
+        std::cerr << "ERROR: the drawing process did not report\n";
+    }
+    close(report[0]);
+    close(master);
+
+    std::cout << "  " << (backend == Screen::b_ansi ? "ansi  " : "curses")
+              << "  first frame : " << counted[0] << " bytes, then "
+              << (double)counted[1] / frames << " bytes/frame (" << arrived
+              << " bytes on the terminal in all)\n";
+}
+
+/**
+ * @brief bytes per frame of the ncurses and ANSI terminal backends.
+ *
+ * usage: term <map file> [frames]
+ */
+static int bench_term(int argc, char *argv[]) {
+    if (argc < 3) {
+        std::cerr << "usage: mine_bench term <map file> [frames]\n";
+        return 1;
+    }
+    unsigned int frames = (argc > 3) ? std::stoul(argv[3]) : 2000;
+    Map_parser   parser(argv[2]);
+    if (!parser.is_good() || (parser.get_rows() > 36) || (parser.get_cols() > 116)) {
+        std::cerr << "ERROR: " << argv[2] << " is not a valid map of at most 36x116\n";
+        return 1;
+    }
+
+    std::cout << "term " << parser.get_rows() << "x" << parser.get_cols() << ", " << frames
+              << " frames\n";
+    term_walk(Screen::b_curses, argv[2], frames);
+    term_walk(Screen::b_ansi, argv[2], frames);
+    return 0;
+}
+
+/**
+ * @brief CPU time used by the calling thread, in seconds.
+ */
+static double thread_cpu_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief player sessions hosted as coroutines on one thread. Five sessions share
+ *          each game; every session plays and watches the map, fed with keys over
+ *          a socket by a driver thread that types one key per session every ms.
+ *          Sessions per core is what the loop thread's CPU time allows at
+ *          10 keys a second per player.
+ *
+ * usage: sessions [sessions] [keys]
+ */
+static int bench_sessions(int argc, char *argv[]) {
+    const double       keys_per_second = 10;
+    unsigned int       sessions = (argc > 2) ? std::stoul(argv[2]) : 500;
+    unsigned int       keys     = (argc > 3) ? std::stoul(argv[3]) : 1000;
+    const unsigned int rows = 64, cols = 64;
+    unsigned int       games = (sessions + MAX_NUM_PLAYERS - 1) / MAX_NUM_PLAYERS;
+
+    struct bench_game_S {
+        std::unique_ptr<Cell_planes_buffer> buf;
+        sem_t                               semaphore;
+        unsigned int                        generation;
+        game_S                              game;
+    };
+    std::vector<bench_game_S>  game_list(games);
+    std::vector<session_S>     session_list(sessions);
+    std::vector<int>           driver_fds(sessions);
+    std::vector<unsigned char> map;
+    uint32_t                   seed = 77;
+
+    Event_loop loop;
+    if (!loop.is_good()) {
+        perror("epoll");
+        return 1;
+    }
+    make_synthetic_map(map, rows, cols, 32);
+    for (bench_game_S &g : game_list) {
+        g.buf.reset(new Cell_planes_buffer(rows, cols));
+        load_planes(g.buf->planes(), map);
+        sem_init(&g.semaphore, 0, 1);
+        g.generation = 0;
+        g.game       = {g.buf->planes(), &g.semaphore, &g.generation, nullptr, nullptr};
+    }
+    for (unsigned int i = 0; i < sessions; ++i) {
+        int sv[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) != 0) {
+            perror("socketpair");
+            return 1;
+        }
+        driver_fds[i]  = sv[0];
+        game_S &game   = game_list[i / MAX_NUM_PLAYERS].game;
+        unsigned int r = 0;
+        do { r = xorshift32(seed) % (rows * cols); } while (game.planes.cell_value(r) != 0);
+        game.planes.set_players(r, G_PLR0 << (i % MAX_NUM_PLAYERS));
+        session_list[i] = {sv[1], (unsigned char)(G_PLR0 << (i % MAX_NUM_PLAYERS)),
+                           {r / cols, r % cols, r}, false, false, false, {}, 0};
+        loop.spawn(play_session(loop, game, session_list[i]));
+        loop.spawn(watch_session(loop, game, session_list[i]));
+    }
+
+    std::thread driver([&]() {
+        const char moves[] = "hjklyubn";
+        uint32_t   dseed   = 99;
+        auto       round   = bench_clock::now();
+        for (unsigned int k = 0; k < keys; ++k) {
+            // paced, so keys reach the sessions one at a time as typed ones do
+            round += std::chrono::milliseconds(1);
+            std::this_thread::sleep_until(round);
+            for (unsigned int i = 0; i < sessions; ++i) {
+                // a session that won has closed its end
+                send(driver_fds[i], &moves[xorshift32(dseed) & 7], 1, MSG_NOSIGNAL);
+            }
+        }
+        for (int fd : driver_fds) { shutdown(fd, SHUT_WR); }
+    });
+
+    auto   start = bench_clock::now();
+    double cpu   = thread_cpu_seconds();
+    loop.run();
+    cpu         = thread_cpu_seconds() - cpu;
+    double wall = seconds_since(start);
+    driver.join();
+
+    uint64_t moves = 0, rejected = 0, frames = 0;
+    for (session_S &s : session_list) {
+        moves += s.metrics.moves;
+        rejected += s.metrics.rejected_moves;
+        frames += s.frames;
+    }
+    for (int fd : driver_fds) { close(fd); }
+    for (bench_game_S &g : game_list) { sem_destroy(&g.semaphore); }
+
+    uint64_t handled = moves + rejected;
+    std::cout << "sessions " << sessions << " in " << games << " games, " << keys
+              << " keys each, one loop thread\n";
+    std::cout << "  keys handled      : " << handled << " (" << moves << " moves, "
+              << rejected << " rejected), " << frames << " map changes seen\n";
+    std::cout << "  loop thread       : " << cpu * 1e3 << " ms CPU, " << wall * 1e3
+              << " ms wall\n";
+    std::cout << "  per key           : " << cpu / handled * 1e6 << " us CPU\n";
+    std::cout << "  sessions per core : "
+              << (unsigned long)(handled / cpu / keys_per_second) << " at "
+              << keys_per_second << " keys/s each\n";
+    return 0;
+}
+
+/**
+ * @brief one process' share of the arena benchmark: keep a few hundred blocks of
+ *          random sizes alive, freeing a random one for each allocation. When
+ *          checking, every block is filled with a byte of its own and checked when
+ *          it is freed, so two processes ever handed overlapping blocks shows up as
+ *          a mismatch.
+ *
+ * @return unsigned int number of corrupted blocks found, or failed allocations.
+ */
+static unsigned int arena_worker(Shm_arena &arena, unsigned int worker, unsigned int ops,
+                                 bool check) {
+    struct live_S {
+        shm_offset_t  offset;
+        size_t        size;
+        unsigned char fill;
+    };
+    std::vector<live_S> live(256, {0, 0, 0});
+    uint32_t            seed  = 1234 + worker * 7919;
+    unsigned int        wrong = 0;
+
+    for (unsigned int i = 0; i < ops; ++i) {
+        live_S &slot = live[xorshift32(seed) % live.size()];
+        if (slot.offset != 0) {
+            const unsigned char *p = arena.at<unsigned char>(slot.offset);
+            for (size_t b = 0; check && (b < slot.size); ++b) {
+                if (p[b] != slot.fill) {
+                    ++wrong;
+                    break;
+                }
+            }
+            arena.release(slot.offset);
+        }
+        // mostly small, now and then a few pages
+        slot.size   = ((xorshift32(seed) & 15) == 0) ? 4096 + xorshift32(seed) % 60000
+                                                    : 8 + xorshift32(seed) % 500;
+        slot.fill   = (unsigned char)(worker * 31 + i);
+        slot.offset = arena.allocate(slot.size);
+        if (slot.offset == 0) {
+            ++wrong;
+            continue;
+        }
+        if (check) { std::memset(arena.at<unsigned char>(slot.offset), slot.fill, slot.size); }
+    }
+    for (live_S &slot : live) {
+        if (slot.offset != 0) { arena.release(slot.offset); }
+    }
+    return wrong;
+}
+
+/**
+ * @brief allocate and free in the shared segment arena from several processes at
+ *          once, growing the segment from a single page on the way.
+ *
+ * usage: arena [ops] [processes]
+ */
+static int bench_arena(int argc, char *argv[]) {
+    unsigned int ops     = (argc > 2) ? std::stoul(argv[2]) : 1000000;
+    unsigned int procs   = (argc > 3) ? std::stoul(argv[3]) : 4;
+    const size_t page    = sysconf(_SC_PAGESIZE);
+    const size_t reserve = 256 << 20;
+
+    int fd = memfd_create("goldchase_bench_arena", MFD_CLOEXEC);
+    if ((fd < 0) || (ftruncate(fd, page) != 0)) {
+        perror("memfd");
+        return 1;
+    }
+    char *base = (char *)mmap(nullptr, reserve, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    Shm_arena(base, (shm_arena_S *)base, fd).format(page, page, reserve);
+
+    // timed without touching the blocks, then again filling and checking them
+    double       elapsed = 0;
+    unsigned int failed  = 0;
+    for (bool check : {false, true}) {
+        auto start = bench_clock::now();
+        for (unsigned int w = 0; w < procs; ++w) {
+            if (fork() == 0) {
+                // each process gets its own view, as players attaching on their own do
+                Shm_arena arena(base, (shm_arena_S *)base, fd);
+                _exit(arena_worker(arena, w, ops, check) ? 1 : 0);
+            }
+        }
+        for (unsigned int w = 0; w < procs; ++w) {
+            int status = 0;
+            wait(&status);
+            if (!WIFEXITED(status) || (WEXITSTATUS(status) != 0)) { ++failed; }
+        }
+        if (!check) { elapsed = seconds_since(start); }
+    }
+
+    Shm_arena arena(base, (shm_arena_S *)base, fd);
+    std::cout << "arena " << procs << " processes, " << ops << " alloc+free each\n";
+    std::cout << "  alloc + free      : " << elapsed / ops * 1e9
+              << " ns per pair per process, " << (double)ops * procs / elapsed / 1e6
+              << " Mpairs/s in all\n";
+    std::cout << "  segment grew to   : " << arena.get_end() / 1024 << " KB, "
+              << arena.get_used() / 1024 << " KB handed out from the top\n";
+    std::cout << "  corrupted         : " << failed << " processes\n";
+    munmap(base, reserve);
+    close(fd);
+    return failed ? 1 : 0;
+}
+
+// the walls of a binary map as a paged world would keep them: read a
+// MAP_TILE_SIDE square chunk at a time from the map file as the walker comes near,
+// in a fixed number of slots, the least recently used chunk making room for the
+// next. Startup only reads the header.
+struct bench_world_S {
+    int                                    fd = -1;
+    map_binary_header_S                    header;
+    uint32_t                               slots = 0;
+    std::vector<uint64_t>                  keys;      // chunk number + 1 per slot, 0 = free
+    std::vector<uint64_t>                  last_used; // tick per slot, the LRU goes by it
+    std::vector<uint64_t>                  walls;     // MAP_TILE_SIDE words per slot
+    std::unordered_map<uint64_t, uint32_t> index;     // chunk number to slot
+    uint64_t                               tick = 0, hits = 0, loads = 0, evictions = 0;
+    uint64_t                               prefetches = 0, load_ns = 0;
+    uint64_t                               last_chunk = ~0ull; // see world_visit()
+};
+
+static uint64_t world_chunks_across(const bench_world_S &w) {
+    return (w.header.cols + MAP_TILE_SIDE - 1) / MAP_TILE_SIDE;
+}
+
+/**
+ * @brief open a binary map for paging, reading only its header. Text maps have no
+ *          fixed row length, so they can't be read a piece at a time.
+ *
+ * @return false if the file is not a binary map.
+ */
+static bool world_open(const char *map_file, uint32_t slots, bench_world_S &w) {
+    w.fd = open(map_file, O_RDONLY | O_CLOEXEC);
+    if ((w.fd < 0) || (pread(w.fd, &w.header, sizeof(w.header), 0) != sizeof(w.header)) ||
+        (memcmp(w.header.magic, MAP_BINARY_MAGIC, sizeof(w.header.magic)) != 0) ||
+        ((w.header.version != MAP_BINARY_VERSION) && (w.header.version != MAP_TILED_VERSION))) {
+        return false;
+    }
+    w.slots = slots;
+    w.keys.assign(slots, 0);
+    w.last_used.assign(slots, 0);
+    w.walls.assign((size_t)slots * MAP_TILE_SIDE, 0);
+    return true;
+}
+
+/**
+ * @brief read a chunk's walls, one word per row of the chunk: a single read from a
+ *          tiled map, one per row from a row major one. A chunk that can't be read
+ *          is solid wall rather than a hole in the world.
+ */
+static void world_read_chunk(const bench_world_S &w, uint64_t chunk, uint64_t *walls) {
+    uint64_t tile_row = chunk / world_chunks_across(w), tile_col = chunk % world_chunks_across(w);
+
+    if (w.header.version == MAP_TILED_VERSION) {
+        uint64_t offset = map_tile_offset(w.header.cols, tile_row, tile_col);
+        if (pread(w.fd, walls, MAP_TILE_BYTES, offset) != (ssize_t)MAP_TILE_BYTES) {
+            memset(walls, 0xff, MAP_TILE_BYTES);
+        }
+        return;
+    }
+
+    uint64_t      x0    = tile_col * MAP_TILE_SIDE;
+    unsigned int  width = (unsigned int)std::min<uint64_t>(MAP_TILE_SIDE, w.header.cols - x0);
+    unsigned char row[MAP_TILE_SIDE];
+    for (unsigned int r = 0; r < MAP_TILE_SIDE; ++r) {
+        uint64_t y = tile_row * MAP_TILE_SIDE + r;
+        walls[r]   = ~0ull;
+        if ((y >= w.header.rows) ||
+            (pread(w.fd, row, width, sizeof(map_binary_header_S) + y * w.header.cols + x0) !=
+             (ssize_t)width)) {
+            continue;
+        }
+        for (unsigned int c = 0; c < width; ++c) {
+            if (!(row[c] & G_WALL)) { walls[r] &= ~(1ull << c); }
+        }
+    }
+}
+
+/**
+ * @brief ask the kernel to start reading a chunk in, without waiting for it.
+ */
+static void world_read_ahead(const bench_world_S &w, uint64_t chunk) {
+    uint64_t tile_row = chunk / world_chunks_across(w), tile_col = chunk % world_chunks_across(w);
+
+    if (w.header.version == MAP_TILED_VERSION) {
+        posix_fadvise(w.fd, map_tile_offset(w.header.cols, tile_row, tile_col), MAP_TILE_BYTES,
+                      POSIX_FADV_WILLNEED);
+        return;
+    }
+    uint64_t x0 = tile_col * MAP_TILE_SIDE;
+    for (unsigned int r = 0; r < MAP_TILE_SIDE; ++r) {
+        uint64_t y = tile_row * MAP_TILE_SIDE + r;
+        if (y >= w.header.rows) { break; }
+        posix_fadvise(w.fd, sizeof(map_binary_header_S) + y * w.header.cols + x0,
+                      std::min<uint64_t>(MAP_TILE_SIDE, w.header.cols - x0),
+                      POSIX_FADV_WILLNEED);
+    }
+}
+
+/**
+ * @brief a chunk's walls, read in if they aren't kept already.
+ */
+static const uint64_t *world_chunk(bench_world_S &w, uint64_t chunk) {
+    auto found = w.index.find(chunk);
+    if (found != w.index.end()) {
+        ++w.hits;
+        w.last_used[found->second] = ++w.tick;
+        return &w.walls[(size_t)found->second * MAP_TILE_SIDE];
+    }
+
+    // a free slot while there are any, else the least recently used
+    uint32_t s = (uint32_t)w.index.size();
+    if (s == w.slots) {
+        s = (uint32_t)(std::min_element(w.last_used.begin(), w.last_used.end()) -
+                       w.last_used.begin());
+        w.index.erase(w.keys[s] - 1);
+        ++w.evictions;
+    }
+
+    auto start = bench_clock::now();
+    world_read_chunk(w, chunk, &w.walls[(size_t)s * MAP_TILE_SIDE]);
+    w.load_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - start)
+                     .count();
+    ++w.loads;
+    w.keys[s]      = chunk + 1;
+    w.last_used[s] = ++w.tick;
+    w.index[chunk] = s;
+    return &w.walls[(size_t)s * MAP_TILE_SIDE];
+}
+
+static bool world_is_wall(bench_world_S &w, uint64_t row, uint64_t col) {
+    if ((row >= w.header.rows) || (col >= w.header.cols)) { return true; }
+    const uint64_t *walls =
+        world_chunk(w, (row / MAP_TILE_SIDE) * world_chunks_across(w) + col / MAP_TILE_SIDE);
+    return (walls[row % MAP_TILE_SIDE] >> (col % MAP_TILE_SIDE)) & 1;
+}
+
+/**
+ * @brief the walker is at (row, col), having moved by (drow, dcol). Loads the
+ *          chunks next to the walker's, and reads ahead the BENCH_WORLD_AHEAD rows
+ *          of chunks beyond them in the direction of travel when the walker
+ *          enters a new chunk.
+ */
+static void world_visit(bench_world_S &w, uint64_t row, uint64_t col, int drow, int dcol) {
+    const int64_t down   = (w.header.rows + MAP_TILE_SIDE - 1) / MAP_TILE_SIDE;
+    const int64_t across = world_chunks_across(w);
+    const int64_t cy = row / MAP_TILE_SIDE, cx = col / MAP_TILE_SIDE;
+
+    for (int64_t y = cy - 1; y <= cy + 1; ++y) {
+        for (int64_t x = cx - 1; x <= cx + 1; ++x) {
+            if ((y < 0) || (y >= down) || (x < 0) || (x >= across)) { continue; }
+            world_chunk(w, y * across + x);
+        }
+    }
+
+    // reading ahead once per chunk entered is enough, the kernel remembers
+    int sy = (drow > 0) - (drow < 0), sx = (dcol > 0) - (dcol < 0);
+    if (((sy == 0) && (sx == 0)) || ((uint64_t)(cy * across + cx) == w.last_chunk)) { return; }
+    w.last_chunk = cy * across + cx;
+    for (int d = 1; d <= BENCH_WORLD_AHEAD; ++d) {
+        for (int k = -1; k <= 1; ++k) {
+            // straight on, the whole row of chunks ahead; diagonally, the corner
+            if ((sy != 0) && (sx != 0) && (k != 0)) { continue; }
+            int64_t y = cy + sy * (1 + d) + ((sy == 0) ? k : 0);
+            int64_t x = cx + sx * (1 + d) + ((sx == 0) ? k : 0);
+            if ((y < 0) || (y >= down) || (x < 0) || (x >= across)) { continue; }
+            if (w.index.count(y * across + x) == 0) {
+                world_read_ahead(w, y * across + x);
+                ++w.prefetches;
+            }
+        }
+    }
+}
+
+/**
+ * @brief one walk across a paged world: a walker heading one way for a while,
+ *          then turning, with every step checked against the walls and the
+ *          chunks around it loaded. The map file is dropped from the page cache
+ *          first, so chunks come from the disk unless they were read ahead.
+ *
+ * @param w out, the world at the end of the walk, with its counters.
+ * @param step_ns out, time of each step.
+ * @param startup out, seconds world_open() took.
+ */
+static void world_walk(const char *map_file, unsigned int steps, uint32_t slots,
+                       bool prefetch, bench_world_S &w, std::vector<double> &step_ns,
+                       double &startup) {
+    int map_fd = open(map_file, O_RDONLY);
+    fdatasync(map_fd);
+    posix_fadvise(map_fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(map_fd);
+
+    auto start = bench_clock::now();
+    if (!world_open(map_file, slots, w)) {
+        std::cerr << map_file << ": not a binary map\n";
+        exit(1);
+    }
+    startup = seconds_since(start);
+
+    uint64_t rows = w.header.rows, cols = w.header.cols;
+    uint64_t row = rows / 2, col = cols / 2;
+    uint32_t seed = 0x2545f491;
+    int      drow = 0, dcol = 1;
+    step_ns.clear();
+    for (unsigned int i = 0; i < steps; ++i) {
+        if ((xorshift32(seed) % 2000) == 0) {
+            // turn: a straight heading, now and then a diagonal one
+            drow = (int)(xorshift32(seed) % 3) - 1;
+            dcol = (int)(xorshift32(seed) % 3) - 1;
+            if ((drow == 0) && (dcol == 0)) { dcol = 1; }
+        }
+        // the walker is a ghost, walls only cost the check
+        auto t0 = bench_clock::now();
+        row     = std::min<uint64_t>(rows - 1, std::max<int64_t>(0, (int64_t)row + drow));
+        col     = std::min<uint64_t>(cols - 1, std::max<int64_t>(0, (int64_t)col + dcol));
+        world_visit(w, row, col, prefetch ? drow : 0, prefetch ? dcol : 0);
+        world_is_wall(w, row, col);
+        step_ns.push_back(std::chrono::duration<double, std::nano>(bench_clock::now() - t0)
+                              .count());
+    }
+    close(w.fd);
+}
+
+/**
+ * @brief walk across a world read from its map file a chunk at a time, as a paged
+ *          world would be, with and without reading ahead, and check the chunks
+ *          against loading the map whole when it is small enough. The game itself
+ *          loads maps whole.
+ *
+ * usage: world <binary map> [steps] [chunks cached]
+ */
+static int bench_world(int argc, char *argv[]) {
+    if (argc < 3) {
+        std::cerr << "usage: mine_bench world <binary map> [steps] [chunks cached]\n";
+        return 1;
+    }
+    const char  *map_file = argv[2];
+    unsigned int steps    = (argc > 3) ? std::stoul(argv[3]) : 100000;
+    uint32_t     slots    = (argc > 4) ? std::stoul(argv[4]) : 256;
+    // the walker's own chunk and the eight around it are in use at once
+    if (slots < 9) {
+        std::cerr << "mine_bench world: at least 9 chunks must be cached\n";
+        return 1;
+    }
+
+    std::cout << "world " << map_file << ", " << steps << " steps, " << slots
+              << " chunks cached\n";
+    uint64_t cells = 0;
+    for (bool prefetch : {false, true}) {
+        bench_world_S       w;
+        std::vector<double> step_ns;
+        double              startup = 0;
+        world_walk(map_file, steps, slots, prefetch, w, step_ns, startup);
+        std::sort(step_ns.begin(), step_ns.end());
+        cells = (uint64_t)w.header.rows * w.header.cols;
+
+        if (!prefetch) {
+            std::cout << "  map               : " << w.header.rows << " x " << w.header.cols
+                      << " (" << (w.header.version == MAP_TILED_VERSION ? "tiled" : "row major")
+                      << ")\n";
+            std::cout << "  startup           : " << startup * 1e6 << " us\n";
+            std::cout << "  resident          : " << w.walls.size() * sizeof(uint64_t) / 1024
+                      << " KB of walls\n";
+        }
+        std::cout << (prefetch ? "  read ahead\n" : "  on demand only\n");
+        std::cout << "    loads           : " << w.loads << ", " << w.evictions
+                  << " evicted, " << (w.loads ? w.load_ns / w.loads / 1000.0 : 0)
+                  << " us each\n";
+        std::cout << "    hits            : " << w.hits << ", " << w.prefetches
+                  << " chunks read ahead\n";
+        std::cout << "    step            : " << step_ns[step_ns.size() / 2] << " ns median, "
+                  << step_ns[step_ns.size() * 99 / 100] << " ns p99, " << step_ns.back()
+                  << " ns max\n";
+    }
+
+    // small enough to load whole: every cell must agree
+    if (cells > (64u << 20)) { return 0; }
+    Map_parser parser(map_file);
+    if (!parser.is_good()) { return 1; }
+    Cell_planes_buffer buf(parser.get_rows(), parser.get_cols());
+    parser.load_walls(buf.planes());
+
+    bench_world_S w;
+    world_open(map_file, slots, w);
+    uint64_t wrong = 0;
+    for (unsigned int y = 0; y < parser.get_rows(); ++y) {
+        for (unsigned int x = 0; x < parser.get_cols(); ++x) {
+            wrong += world_is_wall(w, y, x) != buf.planes().is_wall(y * parser.get_cols() + x);
+        }
+    }
+    close(w.fd);
+    std::cout << "  check             : " << wrong << " cells differ from the whole map\n";
+    return wrong ? 1 : 0;
+}
+
+/**
+ * @brief throughput of the cell scan kernels at each level the CPU runs, over a
+ *          plane of empty cells with a few players near the end, as the scans for
+ *          a player meet it. Every level must give the scalar answers.
+ *
+ * usage: scan [megabytes] [rounds]
+ */
+static int bench_scan(int argc, char *argv[]) {
+    size_t       bytes  = (argc > 2) ? std::stoul(argv[2]) << 20 : 64 << 20;
+    unsigned int rounds = (argc > 3) ? std::stoul(argv[3]) : 10;
+
+    std::vector<unsigned char> a(bytes, 0), b(bytes, 0);
+    std::vector<uint32_t>      dirty(bytes);
+    a[bytes - 100] = G_PLR2;
+    a[bytes - 50]  = G_PLR0;
+    // a frame where one cell in 4096 changed
+    uint32_t seed = 77;
+    for (size_t i = 0; i < bytes / 4096; ++i) { b[xorshift32(seed) % bytes] = G_PLR1; }
+
+    size_t expect[4] = {};
+    std::cout << "scan " << (bytes >> 20) << " MB, " << rounds << " rounds, best level "
+              << cell_scan_level_name(cell_scan_best_level()) << "\n";
+    std::cout << "  level    find_equal  find_any  count_equal  diff   (GB/s)\n";
+    bool wrong = false;
+    for (int level = scan_scalar; level <= cell_scan_best_level(); ++level) {
+        cell_scan_set_level((CELL_SCAN_LEVEL_E)level);
+        size_t got[4] = {};
+        double gbs[4] = {};
+        for (int kernel = 0; kernel < 4; ++kernel) {
+            auto start = bench_clock::now();
+            for (unsigned int r = 0; r < rounds; ++r) {
+                switch (kernel) {
+                case 0:
+                    got[0] = cell_find_equal(a.data(), bytes, G_PLR0);
+                    break;
+                case 1:
+                    got[1] = cell_find_any(a.data(), bytes, G_ANYP);
+                    break;
+                case 2:
+                    got[2] = cell_count_equal(b.data(), bytes, G_PLR1);
+                    break;
+                case 3:
+                    got[3] = cell_diff(a.data(), b.data(), bytes, dirty.data());
+                    break;
+                }
+            }
+            // diff reads both planes
+            gbs[kernel] = (double)bytes * rounds * ((kernel == 3) ? 2 : 1) /
+                          seconds_since(start) / 1e9;
+        }
+        if (level == scan_scalar) { std::copy(got, got + 4, expect); }
+        wrong = wrong || !std::equal(got, got + 4, expect);
+
+        std::cout << "  " << cell_scan_level_name((CELL_SCAN_LEVEL_E)level);
+        for (int k = 0; k < 4; ++k) { std::cout << "\t" << gbs[k]; }
+        std::cout << "\n";
+    }
+    std::cout << "  answers  : " << (wrong ? "DIFFER between levels" : "same at every level")
+              << "\n";
+    cell_scan_set_level(cell_scan_best_level());
+    return wrong ? 1 : 0;
+}
+
+/**
+ * @brief cost of a log record to the thread making it: the asynchronous log
+ *          against writing the message out at once, as perror() does on the
+ *          unbuffered stderr. Records go out in bursts the size of a quarter of
+ *          the ring, with time for the flusher in between.
+ *
+ * usage: log [records]
+ */
+static int bench_log(int argc, char *argv[]) {
+    unsigned int records = (argc > 2) ? std::stoul(argv[2]) : 20000;
+    unsigned int burst   = LOG_RING_RECORDS / 4;
+    std::string  file    = "/tmp/goldchase_bench." + std::to_string(getpid()) + ".log";
+
+    std::cout << "log " << records << " records in bursts of " << burst << "\n";
+    std::cout << "  writer        mean ns   p99 ns   max ns\n";
+    uint64_t dropped = 0;
+    for (bool async : {false, true}) {
+        FILE *sync_out = nullptr;
+        if (async) {
+            setenv(LOG_ENV, file.c_str(), 1);
+            log_start();
+        } else {
+            sync_out = fopen(file.c_str(), "w");
+            setvbuf(sync_out, nullptr, _IONBF, 0);
+        }
+
+        std::vector<double> call_ns;
+        call_ns.reserve(records);
+        for (unsigned int i = 0; i < records; ++i) {
+            auto start = bench_clock::now();
+            if (async) {
+                log_write(log_error, EAGAIN, "ERROR: error in sem_wait() by player %u", i % 5);
+            } else {
+                errno = EAGAIN;
+                fprintf(sync_out, "ERROR: error in sem_wait() by player %u: %s\n", i % 5,
+                        strerror(errno));
+            }
+            call_ns.push_back(seconds_since(start) * 1e9);
+            if ((i + 1) % burst == 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2 * LOG_FLUSH_MS));
+            }
+        }
+
+        if (async) {
+            dropped = log_get_dropped();
+            log_stop();
+        } else {
+            fclose(sync_out);
+        }
+        std::sort(call_ns.begin(), call_ns.end());
+        double mean = 0;
+        for (double ns : call_ns) { mean += ns / call_ns.size(); }
+        std::cout << "  " << (async ? "async ring  " : "synchronous ") << "\t" << mean << "\t"
+                  << call_ns[call_ns.size() * 99 / 100] << "\t" << call_ns.back() << "\n";
+    }
+    unlink(file.c_str());
+    std::cout << "  dropped       : " << dropped << "\n";
+    return dropped ? 1 : 0;
+}
+
+/**
+ * @brief the game's timer wheel with many timers: scheduling, cancelling and
+ *          running every tick until all have fired, against a binary heap (with
+ *          cancelled timers skipped when they reach the top). Every timer must fire
+ *          on its own tick.
+ *
+ * usage: timers [timers] [ticks]
+ */
+static int bench_timers(int argc, char *argv[]) {
+    typedef std::pair<uint64_t, uint32_t> heap_entry;
+
+    uint32_t count = (argc > 2) ? std::stoul(argv[2]) : 100000;
+    uint64_t ticks = (argc > 3) ? std::stoull(argv[3]) : 1ull << 18;
+
+    std::vector<uint64_t> due(count);
+    uint32_t              seed = 99;
+    for (uint32_t i = 0; i < count; ++i) { due[i] = 1 + xorshift32(seed) % ticks; }
+
+    std::cout << "timers " << count << " over " << ticks << " ticks, a quarter cancelled\n";
+    std::cout << "  queue   schedule ns  cancel ns  run ns/tick  fired  late or early\n";
+
+    // the wheel
+    std::vector<uint64_t> memory((timer_wheel_bytes(count) + 7) / 8);
+    Timer_wheel           wheel((timer_wheel_S *)memory.data());
+    std::vector<timer_id_t> ids(count);
+    wheel.format(count, 0);
+
+    auto start = bench_clock::now();
+    for (uint32_t i = 0; i < count; ++i) { ids[i] = wheel.schedule(due[i], 0, i); }
+    double t_schedule = seconds_since(start) * 1e9 / count;
+    start             = bench_clock::now();
+    for (uint32_t i = 0; i < count; i += 4) { wheel.cancel(ids[i]); }
+    double t_cancel = seconds_since(start) * 1e9 / ((count + 3) / 4);
+
+    std::vector<timer_event_S> fired;
+    uint64_t                   wheel_fired = 0, wrong = 0;
+    start = bench_clock::now();
+    for (uint64_t tick = 0; tick <= ticks; ++tick) {
+        fired.clear();
+        wheel.advance(tick, fired);
+        wheel_fired += fired.size();
+        for (const timer_event_S &e : fired) { wrong += (e.due != tick); }
+    }
+    double t_run = seconds_since(start) * 1e9 / (ticks + 1);
+    std::cout << "  wheel\t" << t_schedule << "\t" << t_cancel << "\t" << t_run << "\t"
+              << wheel_fired << "\t" << wrong << "\n";
+
+    // the heap
+    std::priority_queue<heap_entry, std::vector<heap_entry>, std::greater<heap_entry>> heap;
+    std::vector<bool> cancelled(count, false);
+    start = bench_clock::now();
+    for (uint32_t i = 0; i < count; ++i) { heap.push({due[i], i}); }
+    t_schedule = seconds_since(start) * 1e9 / count;
+    start      = bench_clock::now();
+    for (uint32_t i = 0; i < count; i += 4) { cancelled[i] = true; }
+    t_cancel = seconds_since(start) * 1e9 / ((count + 3) / 4);
+
+    uint64_t heap_fired = 0;
+    start               = bench_clock::now();
+    for (uint64_t tick = 0; tick <= ticks; ++tick) {
+        while (!heap.empty() && (heap.top().first <= tick)) {
+            heap_fired += !cancelled[heap.top().second];
+            heap.pop();
+        }
+    }
+    t_run = seconds_since(start) * 1e9 / (ticks + 1);
+    std::cout << "  heap\t" << t_schedule << "\t" << t_cancel << "\t" << t_run << "\t"
+              << heap_fired << "\n";
+
+    bool ok = (wrong == 0) && (wheel_fired == heap_fired) && (wheel.get_pending() == 0);
+    std::cout << "  check   : " << (ok ? "every timer fired on its tick" : "WRONG") << "\n";
+    return ok ? 0 : 1;
+}
+
+static void usage() {
+    std::cout << "usage: mine_bench <benchmark> [args]\n"
+              << "  paths [rows] [cols]   BFS distance field (default 4096x4096)\n"
+              << "  msg [count]           player messaging, mq vs shared rings\n"
+              << "  moves [count]         move kernels: exhaustive check and speed\n"
+              << "  bot <map> [games]     headless games between bots\n"
+              << "  spatial [n] [r] [e]   proximity queries over e entities, index vs scanning\n"
+              << "  fog <map> [radius]    fog of war line of sight\n"
+              << "  term <map> [frames]   terminal bytes per frame, ncurses vs ANSI\n"
+              << "  sessions [n] [keys]   coroutine player sessions on one thread\n"
+              << "  arena [ops] [procs]   shared segment allocator across processes\n"
+              << "  world <map> [steps]   map read a chunk at a time, with and without read ahead\n"
+              << "  scan [MB] [rounds]    SIMD cell scan kernels, GB/s per level\n"
+              << "  log [records]         log record cost, async ring vs synchronous writes\n"
+              << "  timers [n] [ticks]    timer wheel against a binary heap\n";
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        usage();
+        return 1;
+    }
+
+    std::string which = argv[1];
+    if (which == "paths") { return bench_paths(argc, argv); }
+    if (which == "msg") { return bench_msg(argc, argv); }
+    if (which == "moves") { return bench_moves(argc, argv); }
+    if (which == "bot") { return bench_bot(argc, argv); }
+    if (which == "spatial") { return bench_spatial(argc, argv); }
+    if (which == "fog") { return bench_fog(argc, argv); }
+    if (which == "term") { return bench_term(argc, argv); }
+    if (which == "sessions") { return bench_sessions(argc, argv); }
+    if (which == "arena") { return bench_arena(argc, argv); }
+    if (which == "world") { return bench_world(argc, argv); }
+    if (which == "scan") { return bench_scan(argc, argv); }
+    if (which == "log") { return bench_log(argc, argv); }
+    if (which == "timers") { return bench_timers(argc, argv); }
+
+    usage();
+    return 1;
+}
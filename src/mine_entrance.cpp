@@ -10,30 +10,50 @@
  */
 
 #include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <errno.h>
 #include <fcntl.h> /* For O_* constants */
 #include <iostream>
+#include <memory>
 #include <random>
 #include <semaphore.h>
-#include <stdio.h> // for perror
 #include <stdlib.h>
 #include <sys/mman.h>
 #include <sys/stat.h> /* For mode constants */
+#include <time.h>
 #include <unistd.h>
+#include <vector>
 
 #include "Map.h"
+#include "cell_scan.h"
 #include "error_handler.h"
+#include "field_of_view.h"
+#include "game_log.h"
 #include "goldchase.h"
 #include "map_parser.h"
+#include "map_validator.h"
 #include "mine_entrance.h"
+#include "move_journal.h"
+#include "move_kernel.h"
+#include "move_rules.h"
+#include "path_finder.h"
+#include "player_messaging.h"
+#include "render_thread.h"
+#include "segment_share.h"
+#include "shared_segment.h"
+#include "snapshot.h"
+#include "trace.h"
 
-#define SEMAPHORE_NAME "/goldchase_semaphore"
-#define SHARED_MEM_NAME "/goldchase_shared_mem"
 #define SYSCALL_OK 0
-#define MAX_NUM_PLAYERS 5
-
-#define DEBUG(x) (std::cout << x << "\n")
+#define JOURNAL_ENV "GOLDCHASE_JOURNAL" // path of the optional move journal
+#define SPECTATOR_POLL_MS 50                 // spectators check for 'q' this often
+#define INPUT_POLL_MS 50                     // players check for others' moves this often
+#define PROXIMITY_RADIUS 5                   // moves away another player gets announced
+#define TERM_BACKEND_ENV "GOLDCHASE_TERM"    // "ansi" draws the map with Screen::b_ansi
+#define IDLE_ENV "GOLDCHASE_IDLE"            // seconds a player may idle before being kicked
+#define RESPAWN_ENV "GOLDCHASE_RESPAWN"      // seconds between putting missing gold back
+#define ROUND_ENV "GOLDCHASE_ROUND"          // seconds a round lasts
 
 // semaphore and shared memory andother variables declared as a file global since it's
 // used frequently
@@ -41,7 +61,20 @@ static sem_t       *semaphore = nullptr;
 static int          shared_mem_fd;
 static unsigned int player_number     = 0;
 static bool         player_found_gold = false;
-static goldMine_S  *gmp;
+static bool         map_changed       = false; // set by controller(), see apply_moves()
+static move_position_S player_position = {};  // where we were last seen, see controller()
+static unsigned char nearby_players = 0;      // see check_proximity()
+static std::vector<std::string> pending_notices; // queued under the semaphore, see flush_notices()
+static goldMine_S  *gmp = nullptr;
+static size_t       segment_size = 0;
+static Path_finder *path_finder = nullptr;
+static Move_journal journal;
+static bool         share_by_fd     = false; // GOLDCHASE_SHARE=memfd, see segment_share.h
+static int          walls_fd        = -1;    // sealed wall plane, when shared by fd
+static int          share_listen_fd = -1;    // the socket name, held by the first player
+static Share_server *share_server   = nullptr;
+static uint32_t     my_seat         = 0;     // gmp->clock.seat when we joined, see was_kicked()
+static bool         kicked          = false; // for idling, see on_idle_timer()
 
 /**
  * @brief returns a random number between 0 and (x*y).
@@ -81,6 +114,24 @@ unsigned char pn_to_player_bit_mask(unsigned int pn) {
     };
 }
 
+/**
+ * @brief metrics slot of this process' player in the shared segment.
+ *
+ * @return player_metrics_S& counters only this process writes to.
+ */
+player_metrics_S &my_metrics() { return gmp->metrics.players[player_number - 1]; }
+
+/**
+ * @brief monotonic clock in nanoseconds.
+ *
+ * @return uint64_t nanoseconds.
+ */
+uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
 /**
  * @brief turn a player's bit on in the player's mask.
  *
@@ -97,27 +148,90 @@ void set_player_bit(unsigned int pn) { gmp->players |= pn_to_player_bit_mask(pn)
  */
 void reset_player_bit(unsigned int pn) { gmp->players &= ~pn_to_player_bit_mask(pn); }
 
+/**
+ * @brief take a player off the map, reset their bit and give up their seat, so
+ *        their timers are dropped and the slot is free for a new player. Must be
+ *        called with the semaphore held.
+ *
+ * @param pn player number
+ */
+void remove_player(unsigned int pn) {
+    reset_player_bit(pn);
+    unsigned int  cells = gmp->cols * gmp->rows;
+    unsigned char mask  = pn_to_player_bit_mask(pn);
+    unsigned int  i     = cell_find_equal(gmp->occupancy, cells, mask);
+    if (i < cells) {
+        gmp->occupancy[i] = 0;
+        goldmine_spatial(gmp).remove(i, mask);
+        journal.record(journal_leave, mask, i, i);
+    }
+    __atomic_add_fetch(&gmp->clock.seat[pn - 1], 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief was our player kicked, the slot may belong to someone else by now.
+ */
+bool was_kicked() {
+    return __atomic_load_n(&gmp->clock.seat[player_number - 1], __ATOMIC_RELAXED) != my_seat;
+}
+
+/**
+ * @brief does the segment's name still lead to the segment we have mapped, rather
+ *        than nowhere (removed by the last player) or to a new game.
+ */
+bool names_are_ours() {
+    struct stat ours, named;
+    int         fd = shm_open(SHARED_MEM_NAME, O_RDONLY, 0);
+    if (fd < 0) { return false; }
+
+    bool same = (fstat(fd, &named) == SYSCALL_OK) &&
+                (fstat(shared_mem_fd, &ours) == SYSCALL_OK) && (ours.st_dev == named.st_dev) &&
+                (ours.st_ino == named.st_ino);
+    close(fd);
+    return same;
+}
+
 /**
  * @brief shared memory clean up. need to make sure that semaphores are posted before
- * invoking this function.
+ * invoking this function: it takes the semaphore to leave the map.
  *
  */
 void clean_up() {
-    // remove player from map and reset their bit
-    if ((player_number > 0) && (player_number < 6)) {
-        reset_player_bit(player_number);
-        for (unsigned int i = 0; i < (gmp->cols * gmp->rows); ++i) {
-            if ((unsigned int)gmp->map[i] == pn_to_player_bit_mask(player_number)) {
-                gmp->map[i] = 0;
-                break;
-            }
+    // nothing was attached yet (e.g. no game to join)
+    if (gmp == nullptr) { return; }
+
+    // take semaphore, the map and the spatial index are shared with the players
+    // still in the game
+    bool locked = sem_wait(semaphore) == SYSCALL_OK;
+    if (!locked) { handle_error(error_in_sem_wait); }
+
+    // remove player from map and reset their bit, unless that was done when they
+    // were kicked
+    bool removed = false;
+    if (locked && (player_number > 0) && (player_number < 6)) {
+        kicked = kicked || was_kicked();
+        if (!kicked) {
+            remove_player(player_number);
+            goldmine_publish_change(gmp);
+            removed = true;
         }
     }
 
     // if this function was invoked by the only active player (last player in the
-    // game), then clean shared memory and semaphore
-    bool last_one_in_game = ((unsigned int)gmp->players == 0) ? true : false;
+    // game), then clean shared memory and semaphore. A kicked player may be leaving
+    // a game that already ended
+    bool last_one_in_game = locked && ((unsigned int)gmp->players == 0);
+
+    // give semaphore
+    if (locked && (sem_post(semaphore) != SYSCALL_OK)) { handle_error(error_in_sem_post); }
+    if (removed) { goldmine_wake_watchers(gmp); }
+    if (kicked && !share_by_fd) { last_one_in_game = last_one_in_game && names_are_ours(); }
     if (last_one_in_game) {
+        std::vector<unsigned char> final_map(gmp->cols * gmp->rows);
+        goldmine_planes(gmp).compose(final_map.data());
+        journal.finish(map_checksum(final_map.data(), final_map.size()));
+        // a game shared by fd has no names to remove, it goes with the last fd
+        if (share_by_fd) { return; }
         if (sem_close(semaphore) != SYSCALL_OK) { handle_error(error_in_sem_close); }
         if (sem_unlink(SEMAPHORE_NAME) != SYSCALL_OK) {
             handle_error(error_in_sem_unlink);
@@ -127,17 +241,225 @@ void clean_up() {
         }
     }
 
-    DEBUG(std::to_string(player_number));
+    LOG_INFO("player %u left", player_number);
+}
+
+/**
+ * @brief current tick of the game clock, the same in every process.
+ */
+uint64_t game_tick() {
+    return ((int64_t)now_ns() - gmp->clock.epoch_ns) / (GAME_TICK_MS * 1000000ll);
+}
+
+/**
+ * @brief a time in seconds from the environment, in game ticks.
+ *
+ * @param name environment variable.
+ * @return uint32_t 0 if not set.
+ */
+uint32_t ticks_from_env(const char *name) {
+    const char *seconds = getenv(name);
+    return (seconds != nullptr) ? (uint32_t)(atof(seconds) * 1000 / GAME_TICK_MS) : 0;
+}
+
+/**
+ * @brief set the timed rules of a new game from GOLDCHASE_IDLE, GOLDCHASE_RESPAWN and
+ *        GOLDCHASE_ROUND, and start the game's timers. Called when the first player
+ *        sits down, with the semaphore held.
+ */
+void start_game_clock() {
+    game_clock_S &clock = gmp->clock;
+    Timer_wheel   timers = goldmine_timers(gmp);
+
+    clock.epoch_ns      = now_ns();
+    clock.idle_ticks    = ticks_from_env(IDLE_ENV);
+    clock.respawn_ticks = ticks_from_env(RESPAWN_ENV);
+    clock.round_ticks   = ticks_from_env(ROUND_ENV);
+    if (clock.respawn_ticks) { timers.schedule(clock.respawn_ticks, timer_respawn, 0); }
+    if (clock.round_ticks) { timers.schedule(clock.round_ticks, timer_round, 0); }
+}
+
+/**
+ * @brief carry the clock of a restored game on from the tick the snapshot was
+ *        taken at, and give up the seats of the players that were in it. Must be
+ *        called with the semaphore held.
+ */
+void resume_game_clock() {
+    gmp->clock.epoch_ns = now_ns() - goldmine_timers(gmp).get_now() * GAME_TICK_MS * 1000000ll;
+    for (uint32_t &seat : gmp->clock.seat) { ++seat; }
+}
+
+/**
+ * @brief note that our player pressed a key, for the idle timer. Only this process
+ *        writes it, so the semaphore isn't needed.
+ */
+void note_activity() {
+    if (gmp->clock.idle_ticks == 0) { return; }
+    __atomic_store_n(&gmp->clock.last_active[player_number - 1], game_tick(), __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief start the idle timer of a player who just sat down. Must be called with
+ *        the semaphore held.
+ *
+ * @param pn player number
+ */
+void arm_idle_timer(unsigned int pn) {
+    game_clock_S &clock = gmp->clock;
+    if (clock.idle_ticks == 0) { return; }
+
+    clock.last_active[pn - 1] = game_tick();
+    goldmine_timers(gmp).schedule(clock.last_active[pn - 1] + clock.idle_ticks, timer_idle,
+                                  pn | ((clock.seat[pn - 1] & 0xFFFFFF) << 8));
+}
+
+/**
+ * @brief a player's idle timer fired. Kicks them if they haven't pressed a key since
+ *        it was set, else sets it again from their last key, so keys never have to
+ *        touch the wheel. The timer of a player who left is dropped: their seat
+ *        changed.
+ *
+ * @param arg player number | seat << 8
+ * @return true if the map changed.
+ */
+bool on_idle_timer(uint32_t arg) {
+    game_clock_S &clock = gmp->clock;
+    unsigned int  pn    = arg & 0xff;
+
+    if ((pn < 1) || (pn > MAX_NUM_PLAYERS) || ((clock.seat[pn - 1] & 0xFFFFFF) != (arg >> 8)) ||
+        !(gmp->players & pn_to_player_bit_mask(pn))) {
+        return false;
+    }
+
+    uint64_t due = __atomic_load_n(&clock.last_active[pn - 1], __ATOMIC_RELAXED) +
+                   clock.idle_ticks;
+    if (due > game_tick()) {
+        goldmine_timers(gmp).schedule(due, timer_idle, arg);
+        return false;
+    }
+    remove_player(pn);
+    LOG_INFO("player %u kicked for idling", pn);
+    return true;
+}
+
+/**
+ * @brief put a piece of gold on the map the way the map's gold was placed. Must be
+ *        called with the semaphore held.
+ *
+ * @param validator connectivity of the map.
+ * @param kind G_GOLD or G_FOOL.
+ */
+void put_gold(const Map_validator &validator, unsigned char kind) {
+    Cell_planes planes = goldmine_planes(gmp);
+    if (gmp->gold.used >= GOLD_SET_MAX) { planes.compact_gold(); }
+    unsigned int cell = place_gold_piece(planes, validator, kind);
+    goldmine_spatial(gmp).insert(cell, kind);
+    journal.record(journal_place_gold, 0, cell, cell, kind);
+}
+
+/**
+ * @brief the respawn timer fired: put back one piece of the gold picked up so far,
+ *        real gold first, and set the timer again.
+ *
+ * @param due tick the timer was due at.
+ * @param validator connectivity of the map.
+ * @return true if the map changed.
+ */
+bool on_respawn_timer(uint64_t due, const Map_validator &validator) {
+    Cell_planes  planes = goldmine_planes(gmp);
+    unsigned int real   = std::min<unsigned int>(REAL_GOLD_COUNT, gmp->total_num_gold);
+
+    goldmine_timers(gmp).schedule(due + gmp->clock.respawn_ticks, timer_respawn, 0);
+    if (planes.count_gold(G_GOLD) < real) {
+        put_gold(validator, G_GOLD);
+    } else if (planes.count_gold(G_FOOL) < gmp->total_num_gold - real) {
+        put_gold(validator, G_FOOL);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief the round timer fired: the gold left on the map is taken off and all of it
+ *        placed anew, gold carried but not yet off the map is lost (see main_loop()),
+ *        and the next round starts.
+ *
+ * @param due tick the timer was due at.
+ * @param validator connectivity of the map.
+ * @return true, the map changed.
+ */
+bool on_round_timer(uint64_t due, const Map_validator &validator) {
+    Cell_planes   planes  = goldmine_planes(gmp);
+    Spatial_index spatial = goldmine_spatial(gmp);
+    unsigned int  real    = std::min<unsigned int>(REAL_GOLD_COUNT, gmp->total_num_gold);
+
+    for (const gold_entry_S &e : gmp->gold.slots) {
+        if (e.kind == 0) { continue; }
+        unsigned int cell = e.key - 1;
+        spatial.remove(cell, planes.take_gold(cell));
+        journal.record(journal_place_gold, 0, cell, cell, 0);
+    }
+    planes.compact_gold();
+    for (unsigned int i = 0; i < gmp->total_num_gold; ++i) {
+        put_gold(validator, (i < real) ? G_GOLD : G_FOOL);
+    }
+
+    unsigned int round = __atomic_add_fetch(&gmp->clock.round, 1, __ATOMIC_RELEASE);
+    goldmine_timers(gmp).schedule(due + gmp->clock.round_ticks, timer_round, 0);
+    LOG_INFO("round %u over", round);
+    return true;
+}
+
+/**
+ * @brief run the game's timers up to now. Every player's loop calls this: the first
+ *        to see a tick pass takes the semaphore and runs it, the others then find
+ *        nothing due without taking it.
+ *
+ * @param validator connectivity of the map, for placing gold.
+ */
+void run_timers(const Map_validator &validator) {
+    static std::vector<timer_event_S> fired;
+    const game_clock_S               &clock  = gmp->clock;
+    Timer_wheel                       timers = goldmine_timers(gmp);
+
+    if (!clock.idle_ticks && !clock.respawn_ticks && !clock.round_ticks) { return; }
+    uint64_t tick = game_tick();
+    if (tick < timers.get_now()) { return; }
+
+    if (sem_wait(semaphore) != SYSCALL_OK) {
+        handle_error(error_in_sem_wait);
+        return;
+    }
+
+    bool changed = false;
+    fired.clear();
+    timers.advance(tick, fired);
+    for (const timer_event_S &e : fired) {
+        switch (e.kind) {
+        case timer_idle:
+            changed = on_idle_timer(e.arg) || changed;
+            break;
+        case timer_respawn:
+            changed = on_respawn_timer(e.due, validator) || changed;
+            break;
+        case timer_round:
+            changed = on_round_timer(e.due, validator) || changed;
+            break;
+        }
+    }
+    if (changed) { goldmine_publish_change(gmp); }
+
+    if (sem_post(semaphore) != SYSCALL_OK) { handle_error(error_in_sem_post); }
+    if (changed) { goldmine_wake_watchers(gmp); }
 }
 
-void render_map(Map &goldMine) {
+void render_map(Render_thread &renderer) {
 
     std::string str = "player #";
     str += std::to_string(player_number);
-    char cstr[str.length() + 1];
-    std::strcpy(cstr, str.c_str());
 
-    goldMine.postNotice(cstr);
+    renderer.post_toast(str);
 }
 
 /**
@@ -152,6 +474,34 @@ bool check_semaphore_availability() {
     return semval > 0 ? true : false;
 }
 
+/**
+ * @brief initialization_routine() for a game shared by fd. Whoever takes the socket
+ *        name is the first player; the others get the game's fds from it.
+ *
+ * @param argc number of command line arguments
+ */
+void initialization_routine_by_fd(int argc) {
+    if (argc > 1) {
+        share_listen_fd = share_listen();
+        if (share_listen_fd >= 0) {
+            player_number = 1;
+        } else if (errno == EADDRINUSE) {
+            handle_error(error_map_file_specified_by_subsequent_player);
+        } else {
+            LOG_ERRNO("Failed share_listen");
+        }
+    } else {
+        int fds[SHARE_FDS];
+        if (share_receive(fds)) {
+            shared_mem_fd = fds[0];
+            walls_fd      = fds[1];
+            player_number = 2; // temporary for any subsequent player
+        } else {
+            handle_error(error_no_map_file_specified_by_first_player);
+        }
+    }
+}
+
 /**
  * @brief initialization routine to determine player type and number and set up game
  *
@@ -159,7 +509,9 @@ bool check_semaphore_availability() {
  */
 void initialization_routine(int argc) {
 
-    if (argc > 1) {
+    if (share_by_fd) {
+        initialization_routine_by_fd(argc);
+    } else if (argc > 1) {
         // assume first player
         semaphore =
             sem_open(SEMAPHORE_NAME, O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR, 1);
@@ -172,7 +524,7 @@ void initialization_routine(int argc) {
             if (errno == EEXIST) {
                 handle_error(error_map_file_specified_by_subsequent_player);
             } else {
-                perror("Failed sem_open 1");
+                LOG_ERRNO("Failed sem_open 1");
             }
             clean_up();
         }
@@ -186,7 +538,7 @@ void initialization_routine(int argc) {
             if (errno == ENOENT) {
                 handle_error(error_no_map_file_specified_by_first_player);
             } else {
-                perror("Failed sem_open 2");
+                LOG_ERRNO("Failed sem_open 2");
             }
             clean_up();
         }
@@ -195,22 +547,151 @@ void initialization_routine(int argc) {
     return;
 }
 
+/**
+ * @brief open the move journal if GOLDCHASE_JOURNAL names a file. The first player
+ *        creates it and records where the gold was placed, subsequent players
+ *        append to the existing one.
+ *
+ * @param first_player true if called by the first player.
+ */
+void start_journal(bool first_player) {
+    const char *path = getenv(JOURNAL_ENV);
+    if (path == nullptr) { return; }
+
+    if (!first_player) {
+        journal.open(path);
+        return;
+    }
+
+    if (journal.create(path, gmp->rows, gmp->cols)) {
+        for (const gold_entry_S &e : gmp->gold.slots) {
+            if (e.kind != 0) {
+                journal.record(journal_place_gold, 0, e.key - 1, e.key - 1, e.kind);
+            }
+        }
+    }
+}
+
+/**
+ * @brief create the shared game segment. Must be called with the semaphore held.
+ *
+ * @param size size of the segment, see goldmine_segment_size().
+ * @param reserve size to map, see goldmine_reserve_size().
+ * @return goldMine_S* mapped segment, or nullptr on failure.
+ */
+goldMine_S *create_shared_segment(size_t size, size_t reserve) {
+    if (share_by_fd) {
+        // sealed at its full size, see share_create_segment()
+        shared_mem_fd = share_create_segment(reserve);
+        if (shared_mem_fd < 0) {
+            handle_error(error_in_shm_open);
+            return nullptr;
+        }
+    } else {
+        // create shared mem
+        shared_mem_fd =
+            shm_open(SHARED_MEM_NAME, O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+
+        if (shared_mem_fd < 0) {
+            handle_error(error_in_shm_open);
+            return nullptr;
+        }
+
+        // Set shared game size
+        if (ftruncate(shared_mem_fd, size) == -1) {
+            handle_error(error_in_ftruncate);
+            return nullptr;
+        }
+    }
+
+    goldMine_S *segment = (goldMine_S *)mmap(nullptr, reserve, PROT_READ | PROT_WRITE,
+                                             MAP_SHARED, shared_mem_fd, 0);
+    if (segment == MAP_FAILED) {
+        handle_error(error_in_mmap);
+        return nullptr;
+    }
+
+    segment_size = reserve;
+    return segment;
+}
+
+/**
+ * @brief the game's semaphore, when shared by fd: in the segment, created taken
+ *        since nobody can reach the game until it is set up.
+ */
+void create_segment_semaphore() {
+    if (sem_init(&gmp->lock, 1, 0) == SYSCALL_OK) { semaphore = &gmp->lock; }
+}
+
+/**
+ * @brief make the wall plane read only once the map is in. Shared by fd, the walls
+ *        move to a memfd sealed against writes, see share_seal_walls().
+ *
+ * @return false if the walls could not be sealed.
+ */
+bool protect_walls() {
+    if (!share_by_fd) { return goldmine_protect_walls(gmp); }
+    walls_fd = share_seal_walls(gmp);
+    return walls_fd >= 0;
+}
+
+/**
+ * @brief rebuild the shared game segment from a snapshot taken by mine_snapshot.
+ *        The processes that were playing are gone, so their bits are cleared from
+ *        the player mask and the map. Must be called with the semaphore held.
+ *
+ * @param snapshot_file path to snapshot file.
+ * @return true if the game was restored.
+ */
+bool restore_from_snapshot(std::string snapshot_file) {
+    size_t            image_size = 0;
+    const goldMine_S *image      = snapshot_map(snapshot_file, image_size);
+
+    if (image == nullptr) {
+        handle_error(error_snapshot_not_valid);
+        return false;
+    }
+
+    gmp = create_shared_segment(image_size, goldmine_reserve_size(image->rows, image->cols));
+    if (gmp != nullptr) {
+        std::memcpy(gmp, image, image_size);
+        if (share_by_fd) { create_segment_semaphore(); }
+        gmp->players = 0;
+        std::memset(gmp->occupancy, 0, gmp->cols * gmp->rows);
+        goldmine_spatial(gmp).rebuild(goldmine_planes(gmp));
+        resume_game_clock();
+        if (protect_walls()) {
+            start_journal(true);
+        } else {
+            handle_error(error_in_mmap);
+            gmp = nullptr;
+        }
+    }
+
+    snapshot_unmap(image, image_size);
+    return gmp != nullptr;
+}
+
 /**
  * @brief initialize first player process.
  *
  * @param map_file path to map text file, passed by first player as a command line
  * argument
+ * @param restore map_file is a snapshot to restore the game from
  * @return true first player successful initialization
  * @return false otherwise
  */
-bool run_first_player_init_routine(std::string map_file) {
+bool run_first_player_init_routine(std::string map_file, bool restore) {
 
     bool success = false;
 
-    // take semaphore should still be available
-    if (sem_wait(semaphore) != SYSCALL_OK) {
+    // take semaphore should still be available. Shared by fd there is none until
+    // the segment is created, see create_segment_semaphore()
+    if (!share_by_fd && (sem_wait(semaphore) != SYSCALL_OK)) {
         handle_error(error_in_sem_wait);
         success = false;
+    } else if (restore) {
+        success = restore_from_snapshot(map_file);
     } else {
         // parse map
         Map_parser my_map(map_file);
@@ -219,42 +700,39 @@ bool run_first_player_init_routine(std::string map_file) {
             handle_error(error_map_file_specified_is_not_valid);
             success = false;
         } else {
-            // create shared mem
-            shared_mem_fd =
-                shm_open(SHARED_MEM_NAME, O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
-
-            if (shared_mem_fd < 0) {
-                handle_error(error_in_shm_open);
-                success = false;
-            } else {
-                // Set shared game size
-                if (ftruncate(shared_mem_fd, sizeof(goldMine_S) +
-                                                 my_map.get_cols() * my_map.get_rows()) ==
-                    -1) {
-                    handle_error(error_in_ftruncate);
-                }
-
-                // initialize map data
-                gmp = (goldMine_S *)mmap(
-                    nullptr, sizeof(goldMine_S) + my_map.get_cols() * my_map.get_rows(),
-                    PROT_READ | PROT_WRITE, MAP_SHARED, shared_mem_fd, 0);
-                if (gmp == MAP_FAILED) {
-                    handle_error(error_in_mmap);
+            // initialize map data
+            gmp = create_shared_segment(
+                goldmine_segment_size(my_map.get_rows(), my_map.get_cols()),
+                goldmine_reserve_size(my_map.get_rows(), my_map.get_cols()));
+            if (gmp != nullptr) {
+                if (share_by_fd) { create_segment_semaphore(); }
+                gmp->cols = my_map.get_cols();
+                gmp->rows = my_map.get_rows();
+
+                Cell_planes planes = goldmine_planes(gmp);
+                my_map.slurp_map(planes);
+                if (!goldmine_format(gmp, shared_mem_fd)) {
+                    handle_error(error_shm_arena_full);
+                } else if (!my_map.is_good()) {
+                    LOG_ERROR("failed slurp");
                 } else {
-                    gmp->cols = my_map.get_cols();
-                    gmp->rows = my_map.get_rows();
-
-                    my_map.slurp_map(gmp);
-                    if (!my_map.is_good()) { std::cout << "failed slurp\n"; }
-
-                    success = true;
+                    goldmine_spatial(gmp).rebuild(planes);
+                    gmp->total_num_gold = my_map.get_count_of_total_gold();
+                    if (protect_walls()) {
+                        start_journal(true);
+                        success = true;
+                    } else {
+                        handle_error(error_in_mmap);
+                    }
                 }
             }
         }
     }
 
     // give semaphore
-    if (sem_post(semaphore) != SYSCALL_OK) { handle_error(error_in_sem_post); }
+    if ((semaphore != nullptr) && (sem_post(semaphore) != SYSCALL_OK)) {
+        handle_error(error_in_sem_post);
+    }
 
     // given others a chance to grab the semaphore if they have been waiting for it
     // @TODO: make this usleep ... 1 sec is too long
@@ -263,6 +741,37 @@ bool run_first_player_init_routine(std::string map_file) {
     return success;
 }
 
+/**
+ * @brief map the game segment of a running game. By name it must be called with
+ *        the semaphore held, shared by fd it comes before: the semaphore is in the
+ *        segment.
+ *
+ * @return true if attached.
+ */
+bool attach_shared_segment() {
+    if (!share_by_fd) {
+        // open shared mem
+        shared_mem_fd = shm_open(SHARED_MEM_NAME, O_RDWR, S_IRUSR | S_IWUSR);
+        if (shared_mem_fd < 0) {
+            handle_error(error_in_shm_open);
+            return false;
+        }
+    }
+
+    gmp = goldmine_attach(shared_mem_fd, PROT_READ | PROT_WRITE, segment_size);
+    if (gmp == MAP_FAILED) {
+        gmp = nullptr;
+        handle_error(error_in_mmap);
+        return false;
+    }
+
+    if (share_by_fd) {
+        share_map_walls(gmp, walls_fd);
+        semaphore = &gmp->lock;
+    }
+    return true;
+}
+
 /**
  * @brief initialize subsequent player process.
  *
@@ -273,6 +782,8 @@ bool run_subsequent_player_init_routine() {
 
     bool success = false;
 
+    if (share_by_fd && !attach_shared_segment()) { return false; }
+
     // twiddle thumbs until semaphore is available
     while (!check_semaphore_availability()) {}
 
@@ -280,51 +791,40 @@ bool run_subsequent_player_init_routine() {
     if (sem_wait(semaphore) != SYSCALL_OK) {
         handle_error(error_in_sem_wait);
         success = false;
-    } else {
-        // open shared mem
-        shared_mem_fd = shm_open(SHARED_MEM_NAME, O_RDWR, S_IRUSR | S_IWUSR);
-        if (shared_mem_fd < 0) {
-            handle_error(error_in_shm_open);
+    } else if (share_by_fd || attach_shared_segment()) {
+        // get actual player number (lowest available between 1 and 5, all
+        // inclusive)
+        if (pn_to_player_bit_mask(1) & ~gmp->players) {
+            player_number = 1;
+            success       = true;
+        } 
+        else if (pn_to_player_bit_mask(2) & ~gmp->players) {
+            player_number = 2;
+            success       = true;
+        } 
+        else if (pn_to_player_bit_mask(3) & ~gmp->players) {
+            player_number = 3;
+            success       = true;
+        } 
+        else if (pn_to_player_bit_mask(4) & ~gmp->players) {
+            player_number = 4;
+            success       = true;
+        } 
+        else if (pn_to_player_bit_mask(5) & ~gmp->players) {
+            player_number = 5;
+            success       = true;
+        } 
+        else {
+            handle_error(error_max_number_of_players_reached);
             success = false;
-        } else { // successful shm_open call
-            gmp = (goldMine_S *)mmap(nullptr, sizeof(goldMine_S), PROT_READ | PROT_WRITE,
-                                     MAP_SHARED, shared_mem_fd, 0);
-            if (gmp == MAP_FAILED) {
-                handle_error(error_in_mmap);
-            } else {
-                // get actual player number (lowest available between 1 and 5, all
-                // inclusive)
-                if (pn_to_player_bit_mask(1) & ~gmp->players) {
-                    player_number = 1;
-                    success       = true;
-                } 
-                else if (pn_to_player_bit_mask(2) & ~gmp->players) {
-                    player_number = 2;
-                    success       = true;
-                } 
-                else if (pn_to_player_bit_mask(3) & ~gmp->players) {
-                    player_number = 3;
-                    success       = true;
-                } 
-                else if (pn_to_player_bit_mask(4) & ~gmp->players) {
-                    player_number = 4;
-                    success       = true;
-                } 
-                else if (pn_to_player_bit_mask(5) & ~gmp->players) {
-                    player_number = 5;
-                    success       = true;
-                } 
-                else {
-                    handle_error(error_max_number_of_players_reached);
-                    success = false;
-                    // this will tell the clean up function to not look for this
-                    // player on the map as it was never placed
-                    player_number = 6;
-                }
-            }
+            // this will tell the clean up function to not look for this
+            // player on the map as it was never placed
+            player_number = 6;
         }
     }
 
+    if (success) { start_journal(false); }
+
     // give semaphore
     if (sem_post(semaphore) != SYSCALL_OK) { handle_error(error_in_sem_post); }
 
@@ -336,179 +836,255 @@ bool run_subsequent_player_init_routine() {
 }
 
 /**
- * @brief move a player one bit in any direction in 2-D space if legal.
- *        legal move example: into an empty cell or gold.
- *        illegal move example: into a wall or past edge of map.
+ * @brief queue a notice for the player. Called with the semaphore held, so it only
+ *        records the text; flush_notices() shows it once the semaphore is given back.
  *
- * @param player_bit_mask
- * @param target_location
- * @return true if move is allowed.
- * @return false move was illegal and should be ignored.
+ * @param msg notice text.
  */
-void move_player(unsigned int player_bit_mask, unsigned int current_location,
-                 unsigned int target_location, Map &goldMineM) {
-    bool player_found_real_gold  = (gmp->map[target_location] == G_GOLD);
-    bool player_found_fools_gold = (gmp->map[target_location] == G_FOOL);
+void queue_notice(const std::string &msg) { pending_notices.push_back(msg); }
 
-    // check if player found gold
-    if (player_found_real_gold) {
-        goldMineM.postNotice("found real gold!");
-        goldMineM.postNotice("You Won!");
-        player_found_gold = true;
-    }
-    if (player_found_fools_gold) { goldMineM.postNotice("found fool's gold!"); }
-
-    // move player to target location and reset it's previous location
-    gmp->map[current_location] = 0; // empty
-    gmp->map[target_location]  = player_bit_mask;
+/**
+ * @brief show the queued notices as toasts. They go away on their own, the player
+ *        never has to dismiss them.
+ *
+ * @param renderer render thread
+ */
+void flush_notices(Render_thread &renderer) {
+    for (const std::string &msg : pending_notices) { renderer.post_toast(msg); }
+    pending_notices.clear();
 }
 
 /**
- * @brief responds to input keys accordingly to enable player navigation.
+ * @brief responds to input keys accordingly to enable player navigation. Called with
+ *        the semaphore held, notices are queued, see queue_notice().
  *
  * @param input input key recorded from player's keyboard.
- * @param goldMineM Map object
- */
-bool controller(int input, Map &goldMineM) {
-    unsigned int pn                              = 0; // player's number (1..5)
-    unsigned int pl                              = 0; // player's current location
-    unsigned int tl                              = 0; // player's target location
-    bool         move_requested                  = false;
-    bool         player_is_not_going_off_the_map = false;
-    bool         exit_requested                  = false;
-
-    // get player bit mask
-    switch (player_number) {
-    case 1:
-        pn = G_PLR0;
-        break;
-    case 2:
-        pn = G_PLR1;
-        break;
-    case 3:
-        pn = G_PLR2;
+ * @return true if the player left the map (game won).
+ */
+bool controller(int input) {
+    unsigned int pn        = pn_to_player_bit_mask(player_number);
+    DIRECTION_E  direction = direction_of_key(input);
+
+    if (direction == dir_none) { return false; }
+
+    // get player's location, only scan the map if the cached one went stale
+    if ((player_position.cell >= (unsigned int)(gmp->cols * gmp->rows)) ||
+        (gmp->occupancy[player_position.cell] != pn)) {
+        unsigned int i = cell_find_equal(gmp->occupancy, gmp->cols * gmp->rows, pn);
+        if (i < (unsigned int)(gmp->cols * gmp->rows)) {
+            player_position = {i / gmp->cols, i % gmp->cols, i};
+        }
+    }
+
+    Spatial_index  spatial = goldmine_spatial(gmp);
+    move_context_S game    = {goldmine_planes(gmp), &spatial, &journal, &my_metrics()};
+    switch (apply_move(game, pn, direction, player_position, player_found_gold)) {
+    case move_ok:
+        map_changed = true;
         break;
-    case 4:
-        pn = G_PLR3;
+
+    case move_found_gold:
+        map_changed = true;
+        queue_notice("found real gold!");
+        queue_notice("You Won!");
         break;
-    case 5:
-        pn = G_PLR4;
+
+    case move_found_fools_gold:
+        map_changed = true;
+        queue_notice("found fool's gold!");
         break;
-    default:
+
+    case move_exit:
+        // we have gone over the edge with the gold, quit.
+        return true;
+
+    case move_blocked:
+        // fall through
+    case move_off_map:
         break;
     }
 
-    // get player's location
-    if (pn > 0) {
-        for (unsigned int i = 0; i < (gmp->cols * gmp->rows); ++i) {
-            if ((unsigned int)gmp->map[i] == pn) {
-                pl = i;
-                break;
-            }
+    return false;
+}
+
+/**
+ * @brief show how far away the nearest gold is and which key heads toward it.
+ *        The finder is kept for the whole game: only the gold cells are gathered
+ *        under the semaphore, and only if the map changed since the last hint, the
+ *        field is brought up to date after giving it back.
+ *
+ * @param renderer render thread
+ */
+void show_hint(Render_thread &renderer) {
+    static std::vector<unsigned int> gold;
+    static unsigned int              gold_generation = 0;
+    unsigned int                     generation = __atomic_load_n(&gmp->generation,
+                                                                  __ATOMIC_ACQUIRE);
+
+    if ((path_finder == nullptr) || (generation != gold_generation)) {
+        if (sem_wait(semaphore) != SYSCALL_OK) {
+            handle_error(error_in_sem_wait);
+            return;
+        }
+        gold_generation = gmp->generation;
+        gold.clear();
+        for (const gold_entry_S &e : gmp->gold.slots) {
+            if (e.kind != 0) { gold.push_back(e.key - 1); }
+        }
+        if (sem_post(semaphore) != SYSCALL_OK) { handle_error(error_in_sem_post); }
+
+        if (path_finder == nullptr) {
+            path_finder = new Path_finder(goldmine_planes(gmp), gold);
+        } else {
+            path_finder->update_gold(gold);
         }
     }
 
-    // calculate target cell location based on input
-    //     ^
-    //     |
-    // <-hjkl->
-    //    |
-    //    v
-    switch (input) {
+    // only this thread moves our player, so the cached position is current
+    unsigned int dist = path_finder->distance_to_gold(player_position.cell);
+    int          key  = path_finder->next_key(player_position.cell);
 
-    case int('h'):
-        // fall through
-    case int('H'):
-        // check player location against left edge of map
-        player_is_not_going_off_the_map = ((pl % (gmp->cols)) > 0);
-        if (player_is_not_going_off_the_map || player_found_gold) {
-            tl = pl - 1;                                // move left
-            if (gmp->map[tl] & (unsigned char)G_ANYP) { // go over player
-                tl                              = tl - 1;
-                player_is_not_going_off_the_map = ((pl % (gmp->cols)) > 0);
-                if ((player_is_not_going_off_the_map || player_found_gold)) {
-                    move_requested = true;
-                }
-            } else {
-                move_requested = true;
-            }
-        }
-        break;
+    std::string str;
+    if (dist == PATH_UNREACHABLE) {
+        str = "no gold within reach";
+    } else if (key == 0) {
+        str = "the gold is right here";
+    } else {
+        str = "nearest gold: " + std::to_string(dist) + " steps, press '";
+        str += (char)key;
+        str += "'";
+    }
+    renderer.post_toast(str);
+}
 
-    case int('j'):
-        // fall through
-    case int('J'):
-        // check player location against left edge of map
-        player_is_not_going_off_the_map = ((pl / (gmp->rows)) < (gmp->rows * 2 + 1));
-        if (player_is_not_going_off_the_map || player_found_gold) {
-            tl = pl + gmp->cols;                        // move down
-            if (gmp->map[tl] & (unsigned char)G_ANYP) { // go over player
-                tl = tl + gmp->cols;
-                player_is_not_going_off_the_map =
-                    ((tl / (gmp->rows)) < (gmp->rows * 2 + 1));
-                if ((player_is_not_going_off_the_map || player_found_gold)) {
-                    move_requested = true;
-                }
-            } else {
-                move_requested = true;
-            }
-        }
-        break;
+/**
+ * @brief is the key one of the movement keys (hjkl, and yubn for diagonals).
+ *
+ * @param key input key.
+ */
+bool is_move_key(int key) { return direction_of_key(key) != dir_none; }
 
-    case int('k'):
-        // fall through
-    case int('K'):
-        // check player location against top edge of map
-        player_is_not_going_off_the_map = ((pl / (gmp->rows)) > 1);
-        if (player_is_not_going_off_the_map || player_found_gold) {
-            tl = std::max((int)pl - gmp->cols, 0);      // move up
-            if (gmp->map[tl] & (unsigned char)G_ANYP) { // go over player
-                tl                              = tl - gmp->cols;
-                player_is_not_going_off_the_map = ((tl / (gmp->rows)) > 1);
-                if ((player_is_not_going_off_the_map || player_found_gold)) {
-                    move_requested = true;
-                }
-            } else {
-                move_requested = true;
-            }
+/**
+ * @brief look for other players within PROXIMITY_RADIUS moves of us, and queue a
+ *        notice for each that just came near. Must be called with the semaphore held.
+ */
+void check_proximity() {
+    static std::vector<spatial_entity_S> found;
+    unsigned char                        near = 0;
+
+    found.clear();
+    goldmine_spatial(gmp).query_radius(player_position.cell, PROXIMITY_RADIUS,
+                                       G_ANYP & ~pn_to_player_bit_mask(player_number),
+                                       found);
+    for (const spatial_entity_S &e : found) { near |= e.kind; }
+
+    for (unsigned int p = 1; p <= MAX_NUM_PLAYERS; ++p) {
+        if (near & ~nearby_players & pn_to_player_bit_mask(p)) {
+            queue_notice("player " + std::to_string(p) + " is nearby");
         }
-        break;
+    }
+    nearby_players = near;
+}
 
-    case int('l'):
-        // fall through
-    case int('L'):
-        // check player location against top edge of map
-        player_is_not_going_off_the_map = ((pl % (gmp->cols)) < (gmp->cols - 1));
-        if (player_is_not_going_off_the_map || player_found_gold) {
-            tl = pl + 1;                                // move right
-            if (gmp->map[tl] & (unsigned char)G_ANYP) { // go over player
-                tl                              = tl + 1;
-                player_is_not_going_off_the_map = ((tl % (gmp->cols)) < (gmp->cols - 1));
-                if ((player_is_not_going_off_the_map || player_found_gold)) {
-                    move_requested = true;
-                }
-            } else {
-                move_requested = true;
-            }
-        }
-        break;
+/**
+ * @brief apply a batch of move keys under a single semaphore acquisition, so a held
+ *        key costs one lock round trip per frame rather than one per key repeat.
+ *
+ * @param keys move keys, in the order they were typed.
+ * @param count number of keys.
+ * @param renderer render thread
+ * @return true if the player left the map (game won).
+ */
+bool apply_moves(const int *keys, size_t count, Render_thread &renderer) {
+    bool     exit_requested = false;
+    uint64_t wait_start     = now_ns();
 
-    default:
-        break;
-    };
+    TRACE_BEGIN("lock_acquire");
+
+    // twiddle thumbs until semaphore is available
+    while (!check_semaphore_availability()) {}
 
-    // if move requested, move player and (expose gold if any), else ignore
-    if (move_requested && (gmp->map[tl] != G_WALL)) {
-        move_player(pn, pl, tl, goldMineM);
-        move_requested = false;
+    // take semaphore
+    if (sem_wait(semaphore) != SYSCALL_OK) {
+        TRACE_END("lock_acquire");
+        handle_error(error_in_sem_wait);
+        return false;
     }
+    TRACE_END("lock_acquire");
+    TRACE_BEGIN("lock_held");
+    metrics_record_lock_wait(my_metrics(), now_ns() - wait_start);
+
+    // kicked while waiting, the slot may be someone else's by now
+    exit_requested = kicked = was_kicked();
+    map_changed    = false;
+    for (size_t i = 0; (i < count) && !exit_requested; ++i) {
+        TRACE_BEGIN("move");
+        exit_requested = controller(keys[i]); // handle any move key
+        TRACE_END("move");
+    }
+    if (map_changed) {
+        check_proximity();
+        goldmine_publish_change(gmp);
+    }
+    LOG_DEBUG("%zu moves, at cell %u", count, player_position.cell);
 
-    // if we have gone over the edge, and have found gold, quit.
-    if (player_found_gold && !player_is_not_going_off_the_map) { exit_requested = true; }
+    TRACE_END("lock_held");
+    // give semaphore
+    if (sem_post(semaphore) != SYSCALL_OK) { handle_error(error_in_sem_post); }
+    if (map_changed) { goldmine_wake_watchers(gmp); }
 
+    flush_notices(renderer);
     return exit_requested;
 }
 
+/**
+ * @brief ask for a recipient (or everyone) and a text, and send it.
+ *
+ * @param messaging our messaging endpoint.
+ * @param broadcast send to every other player instead of asking for one.
+ * @param renderer render thread, kept off the screen while the dialogs are up.
+ */
+void send_message(Player_messaging &messaging, bool broadcast, Render_thread &renderer) {
+    unsigned char others = gmp->players & ~pn_to_player_bit_mask(player_number);
+    unsigned int  to     = 0;
+
+    if (others == 0) {
+        renderer.post_toast("nobody else is playing");
+        return;
+    }
+    std::unique_lock<std::mutex> screen    = renderer.hold_screen();
+    Map                         &goldMineM = renderer.get_map();
+    if (!broadcast) {
+        unsigned int mask = goldMineM.getPlayer(others);
+        if (mask == 0) { return; }
+        while (pn_to_player_bit_mask(to + 1) != mask) { ++to; }
+        ++to;
+    }
+
+    std::string text = goldMineM.getMessage();
+    screen.unlock();
+    if (text.empty()) { return; }
+
+    bool sent = broadcast ? messaging.broadcast(others, text) : messaging.send(to, text);
+    if (!sent) { renderer.post_toast("message not delivered, inbox full"); }
+}
+
+/**
+ * @brief show every message waiting in our inbox.
+ *
+ * @param messaging our messaging endpoint.
+ * @param renderer render thread
+ */
+void show_messages(Player_messaging &messaging, Render_thread &renderer) {
+    message_S msg;
+
+    while (messaging.receive(msg)) {
+        std::string str = "Player " + std::to_string(msg.from) + " says: " +
+                          std::string(msg.text, msg.length);
+        renderer.post_toast(str);
+    }
+}
+
 /**
  * @brief main loop. to be invoked after proper initialization.
  *
@@ -516,79 +1092,263 @@ bool controller(int input, Map &goldMineM) {
 void main_loop() {
     bool exit_requested = false;
 
-    // place current player randomly in empty spaces in map
+    // place current player randomly in empty spaces in map, only where the gold
+    // can be reached from
+    Cell_planes   planes = goldmine_planes(gmp);
+    Map_validator validator(planes);
+    if (sem_wait(semaphore) != SYSCALL_OK) {
+        handle_error(error_in_sem_wait);
+        return;
+    }
     set_player_bit(player_number);
+    metrics_add(my_metrics().joins);
+    if (gmp->clock.epoch_ns == 0) { start_game_clock(); }
+    my_seat = gmp->clock.seat[player_number - 1];
+    arm_idle_timer(player_number);
     while (1) {
         unsigned int r = get_random_number(gmp->rows, gmp->cols);
-        if (gmp->map[r] == 0) {
-            gmp->map[r] = pn_to_player_bit_mask(player_number);
+        if ((planes.cell_value(r) == 0) && validator.is_playable(r)) {
+            planes.set_players(r, pn_to_player_bit_mask(player_number));
+            goldmine_spatial(gmp).insert(r, pn_to_player_bit_mask(player_number));
+            journal.record(journal_join, planes.players(r), r, r);
+            player_position = {r / gmp->cols, r % gmp->cols, r};
+            goldmine_publish_change(gmp);
+            LOG_INFO("player %u joined at cell %u", player_number, r);
             break;
         }
     }
+    if (sem_post(semaphore) != SYSCALL_OK) { handle_error(error_in_sem_post); }
+    goldmine_wake_watchers(gmp);
+    unsigned int seen_round = gmp->clock.round;
+
+    Player_messaging messaging(message_transport_from_env(), &gmp->messages,
+                               player_number);
+    if (!messaging.is_good()) { log_write(log_warn, errno, "messaging disabled"); }
+
+    // fog of war: GOLDCHASE_FOG=<sight radius>, 0 to see as far as the walls allow
+    const char                    *fog = getenv(FOG_ENV);
+    std::unique_ptr<Field_of_view> fov;
+    if (fog != nullptr) { fov.reset(new Field_of_view(planes, atoi(fog))); }
+
+    // frame rate cap of the render thread: GOLDCHASE_FPS=<frames per second>
+    const char  *fps_env = getenv(RENDER_FPS_ENV);
+    unsigned int fps     = (fps_env != nullptr) ? atoi(fps_env) : RENDER_DEFAULT_FPS;
 
     try {
-        Map goldMineM(gmp->map, gmp->rows, gmp->cols);
-        render_map(goldMineM);
+        Map           goldMineM(planes, fov != nullptr);
+        Render_thread renderer(goldMineM, planes, fov.get(), fps, my_metrics());
+        render_map(renderer);
 
+        // this thread only reads keys and commits moves, the map is drawn by the
+        // render thread from the snapshots published here
+        unsigned int drawn_generation = ~0u;
         while (!exit_requested) {
-            // update map
-            goldMineM.drawMap();
+            run_timers(validator);
+            if (was_kicked()) {
+                kicked = true;
+                break;
+            }
 
-            // get user input
-            // H, J, K, or L to move. Q to quit.
-            int input = goldMineM.getKey();
+            // a new round: the gold was placed anew, and any we carried is lost
+            unsigned int round = __atomic_load_n(&gmp->clock.round, __ATOMIC_ACQUIRE);
+            if (round != seen_round) {
+                seen_round        = round;
+                player_found_gold = false;
+                renderer.post_toast("time's up! round " + std::to_string(round + 1) +
+                                    ", the gold has moved");
+            }
 
-            switch (input) {
-
-            case int('h'):
-                // fall through
-            case int('H'):
-                // fall through
-            case int('j'):
-                // fall through
-            case int('J'):
-                // fall through
-            case int('k'):
-                // fall through
-            case int('K'):
-                // fall through
-            case int('l'):
-                // fall through
-            case int('L'):
-                // twiddle thumbs until semaphore is available
-                while (!check_semaphore_availability()) {}
-
-                // take semaphore
-                if (sem_wait(semaphore) != SYSCALL_OK) {
-                    handle_error(error_in_sem_wait);
-                } else {
-                    exit_requested = controller(input, goldMineM); // handle any move key
-                    // give semaphore
-                    if (sem_post(semaphore) != SYSCALL_OK) {
-                        handle_error(error_in_sem_post);
-                    }
-                }
-                break;
+            // publish the map, only when it changed (our own moves or anyone else's)
+            unsigned int generation = __atomic_load_n(&gmp->generation, __ATOMIC_ACQUIRE);
+            if (generation != drawn_generation) {
+                drawn_generation = generation;
+                renderer.publish(planes, player_position.cell);
+            }
 
-            case int('q'):
-                // fall through
-            case int('Q'):
-                exit_requested = true;
-                break;
+            if (messaging.is_good()) { show_messages(messaging, renderer); }
+
+            // get user input, everything typed since the last frame at once
+            // H, J, K, L (Y, U, B, N diagonally) to move. ? for a hint. M to message
+            // a player, A to message all. Q to quit.
+            if (!goldMineM.waitForInput(INPUT_POLL_MS)) { continue; }
+            std::vector<int> keys = goldMineM.readKeys();
+            note_activity();
+            // the terminal went away, nobody is left to press 'q'
+            if (goldMineM.inputClosed()) { keys.push_back('q'); }
+
+            size_t i = 0;
+            while ((i < keys.size()) && !exit_requested) {
+                // a run of move keys (e.g. key repeat) is applied as one batch
+                if (is_move_key(keys[i])) {
+                    size_t end = i;
+                    while ((end < keys.size()) && is_move_key(keys[end])) { ++end; }
+                    exit_requested = apply_moves(&keys[i], end - i, renderer);
+                    i              = end;
+                    continue;
+                }
 
-            default:
-                break;
-            };
+                switch (keys[i]) {
+                case int('?'):
+                    show_hint(renderer);
+                    break;
+
+                case int('m'):
+                    // fall through
+                case int('M'):
+                    // fall through
+                case int('a'):
+                    // fall through
+                case int('A'):
+                    if (messaging.is_good()) {
+                        send_message(messaging, (keys[i] | 0x20) == 'a', renderer);
+                    }
+                    drawn_generation = ~0u;
+                    break;
+
+                case int('q'):
+                    // fall through
+                case int('Q'):
+                    exit_requested = true;
+                    break;
+
+                default:
+                    break;
+                };
+                ++i;
+            }
         }
 
     } catch (const std::exception &e) {
         handle_error(error_map_constructor_threw_an_exception);
-        std::cerr << e.what() << '\n';
+        LOG_ERROR("%s", e.what());
+    }
+}
+
+/**
+ * @brief "--validate <map file>" mode: parse and check a map without starting a
+ *        game, reporting its connectivity and how long each stage took.
+ *
+ * @param map_file path to map text file.
+ * @return int process exit code, 0 if the map is playable.
+ */
+int validate_map(std::string map_file) {
+    typedef std::chrono::steady_clock clock;
+
+    auto       start = clock::now();
+    Map_parser my_map(map_file);
+    if (!my_map.is_good()) {
+        handle_error(error_map_file_specified_is_not_valid);
+        return 1;
     }
+
+    // scratch map planes, outside any game segment
+    Cell_planes_buffer buf(my_map.get_rows(), my_map.get_cols());
+    my_map.load_walls(buf.planes());
+    auto parsed = clock::now();
+
+    Map_validator validator(buf.planes());
+    auto          labelled = clock::now();
+
+    bool playable = validator.is_good() && (validator.get_playable_size() >=
+                                            my_map.get_count_of_total_gold() +
+                                                MAX_NUM_PLAYERS);
+
+    std::cout << map_file << ": " << my_map.get_rows() << " rows x " << my_map.get_cols()
+              << " cols\n";
+    std::cout << "  components      : " << validator.get_component_count() << " ("
+              << validator.get_edge_component_count() << " touching the edge)\n";
+    std::cout << "  playable cells  : " << validator.get_playable_size() << "\n";
+    std::cout << "  gold            : " << my_map.get_count_of_total_gold() << "\n";
+    std::cout << "  parse           : "
+              << std::chrono::duration<double, std::milli>(parsed - start).count()
+              << " ms\n";
+    std::cout << "  flood fill      : "
+              << std::chrono::duration<double, std::milli>(labelled - parsed).count()
+              << " ms\n";
+    std::cout << "  result          : " << (playable ? "OK" : "NOT PLAYABLE") << "\n";
+
+    return playable ? 0 : 1;
+}
+
+/**
+ * @brief "--spectate" mode: watch a running game without taking a player slot.
+ *        The segment is mapped read-only and the semaphore is never taken; the map
+ *        is redrawn whenever a player publishes a change.
+ *
+ * @return int process exit code.
+ */
+int spectate() {
+    size_t spectated_size = 0;
+    int    fds[SHARE_FDS] = {-1, -1};
+
+    if (share_by_fd) {
+        if (!share_receive(fds)) { fds[0] = -1; }
+    } else {
+        fds[0] = shm_open(SHARED_MEM_NAME, O_RDONLY, 0);
+    }
+    if (fds[0] < 0) {
+        handle_error(error_no_map_file_specified_by_first_player);
+        return 1;
+    }
+    const goldMine_S *game = goldmine_attach(fds[0], PROT_READ, spectated_size);
+    if ((game != MAP_FAILED) && (fds[1] >= 0)) {
+        share_map_walls(const_cast<goldMine_S *>(game), fds[1]);
+    }
+    for (int fd : fds) {
+        if (fd >= 0) { close(fd); }
+    }
+    if (game == MAP_FAILED) {
+        handle_error(error_in_mmap);
+        return 1;
+    }
+
+    try {
+        // only read through, the mapping itself is read only
+        Map          goldMineM(goldmine_planes(const_cast<goldMine_S *>(game)));
+        unsigned int seen        = game->generation;
+        bool         had_players = (game->players != 0);
+
+        goldMineM.setKeyTimeout(0);
+        while (true) {
+            if (goldmine_wait_for_change(game, seen, SPECTATOR_POLL_MS)) {
+                seen = __atomic_load_n(&game->generation, __ATOMIC_ACQUIRE);
+                goldMineM.drawMap();
+            }
+
+            // the game is over once the last player has left
+            had_players = had_players || (game->players != 0);
+            if (had_players && (game->players == 0)) { break; }
+
+            int input = goldMineM.getKey();
+            if ((input == int('q')) || (input == int('Q'))) { break; }
+        }
+        goldMineM.setKeyTimeout(-1);
+    } catch (const std::exception &e) {
+        handle_error(error_map_constructor_threw_an_exception);
+        LOG_ERROR("%s", e.what());
+    }
+
+    goldmine_detach((goldMine_S *)game, spectated_size);
+    return 0;
 }
 
 int main(int argc, char *argv[]) {
-    bool init_went_ok = false;
+    bool        init_went_ok = false;
+    const char *term         = getenv(TERM_BACKEND_ENV);
+
+    if ((term != nullptr) && (std::string(term) == "ansi")) {
+        Screen::setBackend(Screen::b_ansi);
+    }
+
+    share_by_fd = share_by_fd_from_env();
+
+    if ((argc > 1) && (std::string(argv[1]) == "--spectate")) { return spectate(); }
+
+    if ((argc > 2) && (std::string(argv[1]) == "--validate")) {
+        return validate_map(argv[2]);
+    }
+
+    TRACE_BEGIN("init");
 
     // set player number
     initialization_routine(argc);
@@ -597,15 +1357,31 @@ int main(int argc, char *argv[]) {
     if (player_number == 0) {
         exit(1);
     } else if (player_number == 1) {
-        init_went_ok = run_first_player_init_routine((std::string)argv[1]);
+        bool restore = (argc > 2) && (std::string(argv[1]) == "--restore");
+        init_went_ok = run_first_player_init_routine((std::string)argv[restore ? 2 : 1],
+                                                     restore);
     } else { // if ((player_number > 1)) {
         init_went_ok = run_subsequent_player_init_routine();
     }
 
+    TRACE_END("init");
+
     // main loop -- all players run here
     if (init_went_ok) {
+        if (share_by_fd) {
+            // hand the game to joiners, from now until this player leaves
+            int game_fds[SHARE_FDS] = {shared_mem_fd, walls_fd};
+            share_server    = new Share_server(game_fds, share_listen_fd);
+            share_listen_fd = -1;
+        }
+        // the screen is the game's from here on, messages go to the log file
+        log_start();
         main_loop();
+        delete share_server;
         clean_up();
+        log_stop();
+        if (kicked) { std::cerr << "you were idle too long and left the game\n"; }
+        delete path_finder;
     } else {
         handle_error(error_failed_initialization);
     }
@@ -1,13 +1,51 @@
 #ifndef __MINE_ENTRANCE_H__
 #define __MINE_ENTRANCE_H__
 
+#include <semaphore.h>
+
+#include "cell_planes.h"
+#include "game_metrics.h"
+#include "player_messaging.h"
+#include "shm_arena.h"
+
+#define SEMAPHORE_NAME "/goldchase_semaphore"
+#define SHARED_MEM_NAME "/goldchase_shared_mem"
+#define MAX_NUM_PLAYERS 5
+#define GAME_TICK_MS 100 // resolution of the game clock, see game_clock_S
+
+// what a timer of the game's timer wheel does when it fires, see timer_wheel.h
+enum GAME_TIMER_E { timer_idle, timer_respawn, timer_round };
+
+// timed rules of the game, set by the first player. Times are ticks of GAME_TICK_MS
+// since epoch_ns, the same in every process.
+struct game_clock_S {
+    uint64_t epoch_ns;      // CLOCK_MONOTONIC of tick 0
+    uint32_t idle_ticks;    // players idle this long are kicked, 0 = never
+    uint32_t respawn_ticks; // a missing piece of gold is put back this often, 0 = never
+    uint32_t round_ticks;   // length of a round, 0 = one endless round
+    uint32_t round;         // rounds over so far
+    uint64_t last_active[MAX_NUM_PLAYERS]; // tick of each player's last key
+    uint32_t seat[MAX_NUM_PLAYERS];        // bumped whenever a player slot is given up
+};
+
 // game shared data
 struct goldMine_S {
     unsigned short total_num_gold;
     unsigned short rows;
     unsigned short cols;
     unsigned char  players;
-    unsigned char  map[];
+    unsigned int   generation; // bumped on every map change, see goldmine_publish_change()
+    sem_t          lock; // the semaphore of a game shared by fd, see segment_share.h
+    game_metrics_S metrics;
+    message_rings_S messages; // player to player messages, see player_messaging.h
+    gold_set_S      gold;     // gold plane, see cell_planes.h
+    shm_arena_S     arena;    // allocator for the rest of the segment, see shm_arena.h
+    shm_offset_t    spatial;  // spatial_index_S, in the arena. see goldmine_spatial()
+    shm_offset_t    timers;   // timer_wheel_S, in the arena. see goldmine_timers()
+    game_clock_S    clock;
+    unsigned char   occupancy[]; // player bits, one byte per cell
+    // the wall bitset follows on its own pages, see goldmine_planes(), then the
+    // arena up to the end of the segment
 };
 
 #endif // __MINE_ENTRANCE_H__
\ No newline at end of file
@@ -0,0 +1,126 @@
+/**
+ * @file mine_replay.cpp
+ * @author Feras Alshehri (falshehri@mail.csuchico.edu)
+ * @brief re-applies a move journal against its map as fast as possible, reports the
+ *          replay rate and checks the final map against the journal's checksum.
+ *
+ *        usage: mine_replay <journal> <map file> [-r repeats]
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "cell_planes.h"
+#include "goldchase.h"
+#include "map_parser.h"
+#include "move_journal.h"
+
+/**
+ * @brief apply records[0..count) to the map.
+ *
+ * @param map map cells holding only the walls.
+ * @param records journal records.
+ * @param count number of records.
+ * @return uint64_t number of records that were moves.
+ */
+static uint64_t replay(unsigned char *map, const journal_record_S *records,
+                       uint64_t count) {
+    uint64_t moves = 0;
+
+    for (uint64_t i = 0; i < count; ++i) {
+        const journal_record_S &r = records[i];
+        switch (r.event) {
+        case journal_place_gold:
+            map[r.to] = r.outcome;
+            break;
+        case journal_join:
+            map[r.to] = r.player;
+            break;
+        case journal_move:
+            map[r.from] = 0;
+            map[r.to]   = r.player;
+            ++moves;
+            break;
+        case journal_leave:
+            map[r.from] = 0;
+            break;
+        }
+    }
+    return moves;
+}
+
+int main(int argc, char *argv[]) {
+    typedef std::chrono::steady_clock clock;
+
+    if (argc < 3) {
+        std::cerr << "usage: mine_replay <journal> <map file> [-r repeats]\n";
+        return 1;
+    }
+    unsigned int repeats = 1;
+    if ((argc > 4) && (std::string(argv[3]) == "-r")) { repeats = std::stoul(argv[4]); }
+
+    Move_journal journal;
+    if (!journal.open(argv[1], true)) {
+        std::cerr << "ERROR: " << argv[1] << " is not a move journal\n";
+        return 1;
+    }
+    journal_header_S *header = journal.get_header();
+    uint64_t          count  = header->head.load();
+
+    if (count > header->capacity) {
+        std::cerr << "ERROR: journal wrapped (" << count << " records, capacity "
+                  << header->capacity << "), the start of the game is lost\n";
+        return 1;
+    }
+
+    Map_parser my_map(argv[2]);
+    if (!my_map.is_good() || (my_map.get_rows() != header->rows) ||
+        (my_map.get_cols() != header->cols)) {
+        std::cerr << "ERROR: " << argv[2] << " does not match the journal's map ("
+                  << header->rows << "x" << header->cols << ")\n";
+        return 1;
+    }
+
+    // the walls never change, so every repeat starts from the same copy
+    size_t                     cells = (size_t)header->rows * header->cols;
+    Cell_planes_buffer         buf(header->rows, header->cols);
+    std::vector<unsigned char> walls(cells);
+    my_map.load_walls(buf.planes());
+    buf.planes().compose(walls.data());
+
+    std::vector<unsigned char> map(cells);
+    uint64_t                   moves   = 0;
+    double                     elapsed = 0;
+    for (unsigned int i = 0; i < repeats; ++i) {
+        std::memcpy(map.data(), walls.data(), cells);
+        auto start = clock::now();
+        moves      = replay(map.data(), journal.get_records(), count);
+        elapsed += std::chrono::duration<double>(clock::now() - start).count();
+    }
+
+    uint64_t checksum = map_checksum(map.data(), cells);
+    std::cout << "records   : " << count << " (" << moves << " moves)\n";
+    std::cout << "replay    : " << elapsed / repeats * 1e3 << " ms, "
+              << (elapsed > 0 ? count * repeats / elapsed : 0) << " records/s\n";
+    std::cout << "checksum  : " << std::hex << checksum << std::dec << "\n";
+
+    if (!header->finished.load()) {
+        std::cout << "result    : game still running, nothing to compare against\n";
+        return 0;
+    }
+    if (checksum != header->final_checksum.load()) {
+        std::cout << "result    : MISMATCH, expected " << std::hex
+                  << header->final_checksum.load() << std::dec << "\n";
+        return 1;
+    }
+    std::cout << "result    : MATCH\n";
+    return 0;
+}
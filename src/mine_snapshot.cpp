@@ -0,0 +1,83 @@
+/**
+ * @file mine_snapshot.cpp
+ * @author Feras Alshehri (falshehri@mail.csuchico.edu)
+ * @brief takes a snapshot of the running game. Restore it after a host restart with
+ *          "mine_entrance --restore <file>".
+ *
+ *        usage: mine_snapshot <file>
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <chrono>
+#include <fcntl.h>
+#include <iostream>
+#include <semaphore.h>
+#include <stdio.h> // for perror
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+
+#include "error_handler.h"
+#include "mine_entrance.h"
+#include "shared_segment.h"
+#include "snapshot.h"
+
+int main(int argc, char *argv[]) {
+    typedef std::chrono::steady_clock clock;
+
+    size_t segment_size = 0;
+    size_t pages        = 0;
+
+    if (argc < 2) {
+        std::cerr << "usage: mine_snapshot <file>\n";
+        return 1;
+    }
+
+    sem_t *semaphore = sem_open(SEMAPHORE_NAME, O_RDWR);
+    if (semaphore == SEM_FAILED) {
+        perror("ERROR: no game running");
+        return 1;
+    }
+    int fd = shm_open(SHARED_MEM_NAME, O_RDONLY, 0);
+    if (fd < 0) {
+        handle_error(error_in_shm_open);
+        return 1;
+    }
+    goldMine_S *gmp = goldmine_attach(fd, PROT_READ, segment_size);
+    close(fd);
+    if (gmp == MAP_FAILED) {
+        handle_error(error_in_mmap);
+        return 1;
+    }
+
+    // hold the semaphore only to copy the segment out of shared memory; diffing it
+    // against the file, which may have to be read from disk, and syncing it don't
+    auto start = clock::now();
+    if (sem_wait(semaphore) != 0) {
+        handle_error(error_in_sem_wait);
+        return 1;
+    }
+    size_t            used = goldmine_used_size(gmp);
+    std::vector<char> copy((const char *)gmp, (const char *)gmp + used);
+    if (sem_post(semaphore) != 0) { handle_error(error_in_sem_post); }
+    double locked = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+    bool   ok      = snapshot_write((const goldMine_S *)copy.data(), used, argv[1], pages);
+    double elapsed = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+    goldmine_detach(gmp, segment_size);
+    sem_close(semaphore);
+
+    if (!ok) {
+        perror("ERROR: failed to write snapshot");
+        return 1;
+    }
+    std::cout << argv[1] << ": " << pages << " of "
+              << (used + SNAPSHOT_PAGE_SIZE - 1) / SNAPSHOT_PAGE_SIZE
+              << " pages changed, " << elapsed << " ms (" << locked << " ms locked)\n";
+    return 0;
+}
@@ -0,0 +1,164 @@
+/**
+ * @file mine_stats.cpp
+ * @author Feras Alshehri (falshehri@mail.csuchico.edu)
+ * @brief prints the metrics of a running game. Attaches read-only and never takes
+ *          the game semaphore, so it can be run at any time.
+ *
+ *        usage: mine_stats [--json] [--stream <ms>]
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "error_handler.h"
+#include "goldchase.h"
+#include "mine_entrance.h"
+#include "segment_share.h"
+#include "shared_segment.h"
+
+static const unsigned char player_bits[MAX_NUM_PLAYERS] = {G_PLR0, G_PLR1, G_PLR2,
+                                                           G_PLR3, G_PLR4};
+
+/**
+ * @brief one JSON object (single line) with every player slot.
+ *
+ * @param gmp mapped game segment.
+ * @return std::string JSON text.
+ */
+static std::string stats_json(const goldMine_S *gmp) {
+    std::ostringstream out;
+
+    out << "{\"rows\":" << gmp->rows << ",\"cols\":" << gmp->cols
+        << ",\"generation\":" << __atomic_load_n(&gmp->generation, __ATOMIC_RELAXED)
+        << ",\"segment_size\":" << goldmine_used_size(gmp)
+        << ",\"arena_used\":" << goldmine_arena_used(gmp)
+        << ",\"round\":" << __atomic_load_n(&gmp->clock.round, __ATOMIC_RELAXED)
+        << ",\"players\":[";
+    for (unsigned int p = 0; p < MAX_NUM_PLAYERS; ++p) {
+        const player_metrics_S &m = gmp->metrics.players[p];
+        out << (p ? "," : "") << "{\"player\":" << p + 1
+            << ",\"active\":" << ((gmp->players & player_bits[p]) ? "true" : "false")
+            << ",\"joins\":" << metrics_read(m.joins)
+            << ",\"moves\":" << metrics_read(m.moves)
+            << ",\"rejected_moves\":" << metrics_read(m.rejected_moves)
+            << ",\"real_gold_found\":" << metrics_read(m.real_gold_found)
+            << ",\"fools_gold_found\":" << metrics_read(m.fools_gold_found)
+            << ",\"frames_drawn\":" << metrics_read(m.frames_drawn)
+            << ",\"frames_dropped\":" << metrics_read(m.frames_dropped)
+            << ",\"cells_plotted\":" << metrics_read(m.cells_plotted)
+            << ",\"bytes_written\":" << metrics_read(m.bytes_written)
+            << ",\"lock_wait_ns_total\":" << metrics_read(m.lock_wait_ns_total)
+            << ",\"lock_wait_us_hist\":[";
+        for (unsigned int b = 0; b < METRICS_LOCK_WAIT_BUCKETS; ++b) {
+            out << (b ? "," : "") << metrics_read(m.lock_wait_hist[b]);
+        }
+        out << "]}";
+    }
+    out << "]}";
+    return out.str();
+}
+
+/**
+ * @brief human readable table, one row per player slot that was ever used.
+ *
+ * @param gmp mapped game segment.
+ * @return std::string table text.
+ */
+static std::string stats_text(const goldMine_S *gmp) {
+    std::ostringstream out;
+
+    out << "map " << gmp->rows << "x" << gmp->cols << ", generation "
+        << __atomic_load_n(&gmp->generation, __ATOMIC_RELAXED) << ", segment "
+        << goldmine_used_size(gmp) / 1024 << " KB, arena "
+        << goldmine_arena_used(gmp) / 1024 << " KB used\n";
+    const game_clock_S &clock = gmp->clock;
+    if (clock.idle_ticks || clock.respawn_ticks || clock.round_ticks) {
+        out << "round " << __atomic_load_n(&clock.round, __ATOMIC_RELAXED) + 1 << ", idle kick "
+            << clock.idle_ticks * GAME_TICK_MS / 1000.0 << " s, respawn "
+            << clock.respawn_ticks * GAME_TICK_MS / 1000.0 << " s, round "
+            << clock.round_ticks * GAME_TICK_MS / 1000.0 << " s (0 = off)\n";
+    }
+    out << "player active    moves rejected  gold  fool   frames  dropped      cells  bytes/frame  "
+           "avg wait(us)\n";
+    for (unsigned int p = 0; p < MAX_NUM_PLAYERS; ++p) {
+        const player_metrics_S &m = gmp->metrics.players[p];
+        if (metrics_read(m.joins) == 0) { continue; }
+
+        uint64_t waits = 0;
+        for (unsigned int b = 0; b < METRICS_LOCK_WAIT_BUCKETS; ++b) {
+            waits += metrics_read(m.lock_wait_hist[b]);
+        }
+        out << std::setw(6) << p + 1 << std::setw(7)
+            << ((gmp->players & player_bits[p]) ? "yes" : "no") << std::setw(9)
+            << metrics_read(m.moves) << std::setw(9) << metrics_read(m.rejected_moves)
+            << std::setw(6) << metrics_read(m.real_gold_found) << std::setw(6)
+            << metrics_read(m.fools_gold_found) << std::setw(9)
+            << metrics_read(m.frames_drawn) << std::setw(9)
+            << metrics_read(m.frames_dropped) << std::setw(11)
+            << metrics_read(m.cells_plotted) << std::setw(13)
+            << (metrics_read(m.frames_drawn)
+                    ? metrics_read(m.bytes_written) / metrics_read(m.frames_drawn)
+                    : 0)
+            << std::setw(14) << (waits ? metrics_read(m.lock_wait_ns_total) / waits / 1000.0 : 0.0)
+            << "\n";
+    }
+    return out.str();
+}
+
+int main(int argc, char *argv[]) {
+    bool         json      = false;
+    unsigned int stream_ms = 0;
+    size_t       size      = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--json") {
+            json = true;
+        } else if (a == "--stream" && i + 1 < argc) {
+            stream_ms = std::stoul(argv[++i]);
+        } else {
+            std::cerr << "usage: mine_stats [--json] [--stream <ms>]\n";
+            return 1;
+        }
+    }
+
+    // a game shared by fd has no name, ask a player for the segment instead
+    int fds[SHARE_FDS] = {-1, -1};
+    if (share_by_fd_from_env()) {
+        if (!share_receive(fds)) { fds[0] = -1; }
+    } else {
+        fds[0] = shm_open(SHARED_MEM_NAME, O_RDONLY, 0);
+    }
+    if (fds[0] < 0) {
+        handle_error(error_in_shm_open);
+        return 1;
+    }
+    const goldMine_S *gmp = goldmine_attach(fds[0], PROT_READ, size);
+    for (int fd : fds) {
+        if (fd >= 0) { close(fd); }
+    }
+    if (gmp == MAP_FAILED) {
+        handle_error(error_in_mmap);
+        return 1;
+    }
+
+    // streaming prints one JSON object per line (or one table per interval) until
+    // the game ends
+    do {
+        std::cout << (json ? stats_json(gmp) + "\n" : stats_text(gmp)) << std::flush;
+        if (stream_ms > 0) { usleep(stream_ms * 1000); }
+    } while (stream_ms > 0 && gmp->players != 0);
+
+    goldmine_detach((goldMine_S *)gmp, size);
+    return 0;
+}
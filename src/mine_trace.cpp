@@ -0,0 +1,77 @@
+/**
+ * @file mine_trace.cpp
+ * @author Feras Alshehri (falshehri@mail.csuchico.edu)
+ * @brief merges the trace files written by players built with TRACE=1 into one
+ *          Chrome trace (open it in chrome://tracing or ui.perfetto.dev).
+ *
+ *        usage: mine_trace <out.json> <goldchase_trace.*.txt>...
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct merged_event_S {
+    unsigned long long ns;
+    char               phase;
+    int                pid;
+    unsigned int       tid;
+    std::string        name;
+};
+
+int main(int argc, char *argv[]) {
+    std::vector<merged_event_S> events;
+
+    if (argc < 3) {
+        std::cerr << "usage: mine_trace <out.json> <goldchase_trace.*.txt>...\n";
+        return 1;
+    }
+
+    for (int i = 2; i < argc; ++i) {
+        std::ifstream in(argv[i]);
+        std::string   line;
+        if (!in.is_open()) {
+            std::cerr << "ERROR: can't open " << argv[i] << "\n";
+            return 1;
+        }
+        while (std::getline(in, line)) {
+            std::istringstream fields(line);
+            merged_event_S     e;
+            if (fields >> e.ns >> e.phase >> e.pid >> e.tid >> e.name) {
+                events.push_back(e);
+            }
+        }
+    }
+
+    // all processes stamp CLOCK_MONOTONIC nanoseconds, so a plain sort interleaves
+    // them correctly
+    std::stable_sort(events.begin(), events.end(),
+                     [](const merged_event_S &a, const merged_event_S &b) {
+                         return a.ns < b.ns;
+                     });
+    unsigned long long origin = events.empty() ? 0 : events.front().ns;
+
+    std::ofstream out(argv[1]);
+    out << std::fixed << std::setprecision(3); // ts is in microseconds
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    for (size_t i = 0; i < events.size(); ++i) {
+        const merged_event_S &e = events[i];
+        out << (i ? ",\n" : "") << "{\"name\":\"" << e.name << "\",\"ph\":\"" << e.phase
+            << "\",\"ts\":" << (e.ns - origin) / 1000.0 << ",\"pid\":" << e.pid
+            << ",\"tid\":" << e.tid << (e.phase == 'i' ? ",\"s\":\"t\"" : "") << "}";
+    }
+    out << "\n]}\n";
+
+    std::cout << argv[1] << ": " << events.size() << " events from " << argc - 2
+              << " process(es)\n";
+    return 0;
+}
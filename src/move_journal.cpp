@@ -0,0 +1,174 @@
+/**
+ * @file move_journal.cpp
+ * @author Feras Alshehri (falshehri@mail.csuchico.edu)
+ * @brief memory mapped journal of every map mutation, so a session can be replayed
+ *          offline (see mine_replay.cpp).
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "move_journal.h"
+
+Move_journal::Move_journal() {}
+
+Move_journal::~Move_journal() { close(); }
+
+/**
+ * @brief create (or truncate) a journal file and map it.
+ *
+ * @param path journal file path.
+ * @param rows map rows, kept so replay can check it was given the right map.
+ * @param cols map cols.
+ * @param capacity number of record slots in the ring.
+ * @return true on success.
+ */
+bool Move_journal::create(std::string path, unsigned int rows, unsigned int cols,
+                          uint64_t capacity) {
+    close();
+
+    fd = ::open(path.c_str(), O_CREAT | O_TRUNC | O_RDWR, S_IRUSR | S_IWUSR);
+    if (fd < 0) { return false; }
+
+    length = JOURNAL_RECORDS_OFFSET + capacity * sizeof(journal_record_S);
+    if (ftruncate(fd, length) == -1) {
+        close();
+        return false;
+    }
+
+    void *mem = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mem == MAP_FAILED) {
+        close();
+        return false;
+    }
+
+    header           = (journal_header_S *)mem;
+    records          = (journal_record_S *)((char *)mem + JOURNAL_RECORDS_OFFSET);
+    header->version  = JOURNAL_VERSION;
+    header->capacity = capacity;
+    header->rows     = rows;
+    header->cols     = cols;
+    header->head.store(0);
+    header->final_checksum.store(0);
+    header->finished.store(0);
+    header->magic = JOURNAL_MAGIC; // written last, marks the header as complete
+
+    return true;
+}
+
+/**
+ * @brief map an existing journal file.
+ *
+ * @param path journal file path.
+ * @param read_only map without write access (replay).
+ * @return true on success.
+ */
+bool Move_journal::open(std::string path, bool read_only) {
+    struct stat st;
+
+    close();
+
+    fd = ::open(path.c_str(), read_only ? O_RDONLY : O_RDWR);
+    if (fd < 0) { return false; }
+    if ((fstat(fd, &st) == -1) || (st.st_size < JOURNAL_RECORDS_OFFSET)) {
+        close();
+        return false;
+    }
+
+    length    = st.st_size;
+    int  prot = read_only ? PROT_READ : (PROT_READ | PROT_WRITE);
+    void *mem = mmap(nullptr, length, prot, MAP_SHARED, fd, 0);
+    if (mem == MAP_FAILED) {
+        close();
+        return false;
+    }
+
+    header  = (journal_header_S *)mem;
+    records = (journal_record_S *)((char *)mem + JOURNAL_RECORDS_OFFSET);
+    if ((header->magic != JOURNAL_MAGIC) || (header->version != JOURNAL_VERSION) ||
+        (JOURNAL_RECORDS_OFFSET + header->capacity * sizeof(journal_record_S) > length)) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void Move_journal::close() {
+    if (header != nullptr) { munmap(header, length); }
+    if (fd >= 0) { ::close(fd); }
+    fd      = -1;
+    length  = 0;
+    header  = nullptr;
+    records = nullptr;
+}
+
+bool Move_journal::is_open() { return header != nullptr; }
+
+/**
+ * @brief append a record. Safe to call from any process that has the journal open;
+ *          callers mutate the map under the game semaphore anyway, so record order
+ *          matches the order the mutations were applied in.
+ *
+ * @param event what happened.
+ * @param player player bit mask.
+ * @param from source cell.
+ * @param to target cell.
+ * @param outcome event specific detail, see JOURNAL_EVENT_E.
+ */
+void Move_journal::record(JOURNAL_EVENT_E event, unsigned char player, unsigned int from,
+                          unsigned int to, unsigned char outcome) {
+    if (header == nullptr) { return; }
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    uint64_t          slot = header->head.fetch_add(1, std::memory_order_relaxed);
+    journal_record_S &r    = records[slot % header->capacity];
+    r.timestamp_ns         = (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+    r.from                 = from;
+    r.to                   = to;
+    r.player               = player;
+    r.event                = event;
+    r.outcome              = outcome;
+}
+
+/**
+ * @brief mark the game as over and store the final map checksum for replay to
+ *          compare against.
+ *
+ * @param checksum map_checksum() of the final map.
+ */
+void Move_journal::finish(uint64_t checksum) {
+    if (header == nullptr) { return; }
+    header->final_checksum.store(checksum);
+    header->finished.store(1, std::memory_order_release);
+    msync(header, JOURNAL_RECORDS_OFFSET, MS_ASYNC);
+}
+
+journal_header_S *Move_journal::get_header() { return header; }
+journal_record_S *Move_journal::get_records() { return records; }
+
+/**
+ * @brief FNV-1a hash of the map cells.
+ *
+ * @param map map cells.
+ * @param cells number of cells.
+ * @return uint64_t checksum.
+ */
+uint64_t map_checksum(const unsigned char *map, size_t cells) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < cells; ++i) {
+        h ^= map[i];
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
@@ -0,0 +1,73 @@
+#ifndef __MOVE_JOURNAL_H__
+#define __MOVE_JOURNAL_H__
+
+#include <atomic>
+#include <stdint.h>
+#include <string>
+
+#define JOURNAL_MAGIC 0x4c4e524a // "JRNL"
+#define JOURNAL_VERSION 1
+#define JOURNAL_DEFAULT_RECORDS (1u << 20)
+
+enum JOURNAL_EVENT_E : uint8_t {
+    journal_place_gold, // to = cell, outcome = G_GOLD or G_FOOL
+    journal_join,       // to = cell the player was placed on
+    journal_move,       // from -> to, outcome = target cell contents before the move
+    journal_leave,      // from = cell the player was removed from
+};
+
+// one fixed size record per map mutation
+struct journal_record_S {
+    uint64_t timestamp_ns; // CLOCK_MONOTONIC, comparable across processes
+    uint32_t from;
+    uint32_t to;
+    uint8_t  player; // player bit mask
+    uint8_t  event;  // JOURNAL_EVENT_E
+    uint8_t  outcome;
+    uint8_t  reserved[5];
+};
+
+// first page of the journal file, records follow at JOURNAL_RECORDS_OFFSET
+struct journal_header_S {
+    uint32_t              magic;
+    uint32_t              version;
+    uint64_t              capacity; // number of record slots in the ring
+    uint32_t              rows;
+    uint32_t              cols;
+    std::atomic<uint64_t> head;           // total records ever reserved
+    std::atomic<uint64_t> final_checksum; // map checksum when the game ended
+    std::atomic<uint32_t> finished;
+};
+
+#define JOURNAL_RECORDS_OFFSET 4096
+
+/**
+ * @brief append-only journal of map mutations in a memory mapped ring file.
+ *          Writers reserve a slot with one atomic add and fill it in place, so
+ *          recording never takes a lock of its own.
+ */
+class Move_journal {
+  private:
+    int               fd      = -1;
+    size_t            length  = 0;
+    journal_header_S *header  = nullptr;
+    journal_record_S *records = nullptr;
+
+  public:
+    Move_journal();
+    ~Move_journal();
+    bool              create(std::string path, unsigned int rows, unsigned int cols,
+                             uint64_t capacity = JOURNAL_DEFAULT_RECORDS);
+    bool              open(std::string path, bool read_only = false);
+    void              close();
+    bool              is_open();
+    void              record(JOURNAL_EVENT_E event, unsigned char player,
+                             unsigned int from, unsigned int to, unsigned char outcome = 0);
+    void              finish(uint64_t checksum);
+    journal_header_S *get_header();
+    journal_record_S *get_records();
+};
+
+uint64_t map_checksum(const unsigned char *map, size_t cells);
+
+#endif // __MOVE_JOURNAL_H__
@@ -0,0 +1,182 @@
+#ifndef __MOVE_KERNEL_H__
+#define __MOVE_KERNEL_H__
+
+#include "cell_planes.h"
+#include "goldchase.h"
+
+// 8-way movement, vi style:  y k u
+//                            h . l
+//                            b j n
+enum DIRECTION_E {
+    dir_left,
+    dir_down,
+    dir_up,
+    dir_right,
+    dir_up_left,
+    dir_up_right,
+    dir_down_left,
+    dir_down_right,
+    dir_count,
+    dir_none = dir_count,
+};
+
+enum MOVE_OUTCOME_E {
+    move_ok,               // moved into an empty cell
+    move_found_gold,       // moved onto real gold
+    move_found_fools_gold, // moved onto fool's gold
+    move_blocked,          // wall, or a player we can't jump over
+    move_off_map,          // edge of the map, and no gold found yet
+    move_exit,             // walked off the map holding the real gold: game won
+};
+
+// a cell with its row and col, so moving never has to divide by the map width
+struct move_position_S {
+    unsigned int row;
+    unsigned int col;
+    unsigned int cell; // row * cols + col
+};
+
+struct move_result_S {
+    MOVE_OUTCOME_E  outcome;
+    move_position_S target; // position moved to, unchanged unless move_ok/found_*
+};
+
+template <DIRECTION_E D> struct direction_traits;
+template <> struct direction_traits<dir_left> {
+    static constexpr int drow = 0, dcol = -1;
+};
+template <> struct direction_traits<dir_down> {
+    static constexpr int drow = 1, dcol = 0;
+};
+template <> struct direction_traits<dir_up> {
+    static constexpr int drow = -1, dcol = 0;
+};
+template <> struct direction_traits<dir_right> {
+    static constexpr int drow = 0, dcol = 1;
+};
+template <> struct direction_traits<dir_up_left> {
+    static constexpr int drow = -1, dcol = -1;
+};
+template <> struct direction_traits<dir_up_right> {
+    static constexpr int drow = -1, dcol = 1;
+};
+template <> struct direction_traits<dir_down_left> {
+    static constexpr int drow = 1, dcol = -1;
+};
+template <> struct direction_traits<dir_down_right> {
+    static constexpr int drow = 1, dcol = 1;
+};
+
+/**
+ * @brief is the cell k steps in direction D from (row, col) on the map. Only the
+ *          edges D can actually cross are checked, the rest compile away.
+ */
+template <DIRECTION_E D>
+inline bool move_in_bounds(unsigned int row, unsigned int col, unsigned int rows,
+                           unsigned int cols, unsigned int k) {
+    constexpr int dr = direction_traits<D>::drow;
+    constexpr int dc = direction_traits<D>::dcol;
+    bool          ok = true;
+
+    if constexpr (dr < 0) { ok &= (row >= k); }
+    if constexpr (dr > 0) { ok &= (row + k < rows); }
+    if constexpr (dc < 0) { ok &= (col >= k); }
+    if constexpr (dc > 0) { ok &= (col + k < cols); }
+    return ok;
+}
+
+/**
+ * @brief work out what a one step move in direction D does, without changing the
+ *          map. A player in the way is jumped over if the cell behind them is on
+ *          the map and not another player.
+ *
+ * @param planes map planes.
+ * @param from player's current position.
+ * @param has_gold player already found the real gold (may leave the map).
+ * @return move_result_S outcome and target position.
+ */
+template <DIRECTION_E D>
+inline move_result_S move_kernel(const Cell_planes &planes, move_position_S from,
+                                 bool has_gold) {
+    constexpr int dr = direction_traits<D>::drow;
+    constexpr int dc = direction_traits<D>::dcol;
+
+    const unsigned int rows = planes.get_rows();
+    const unsigned int cols = planes.get_cols();
+
+    const int       offset = dr * (int)cols + dc;
+    move_position_S to     = {from.row + dr, from.col + dc, from.cell + offset};
+
+    bool inside = move_in_bounds<D>(from.row, from.col, rows, cols, 1);
+    if (inside && planes.players(to.cell)) { // go over player
+        to     = {to.row + dr, to.col + dc, to.cell + offset};
+        inside = move_in_bounds<D>(from.row, from.col, rows, cols, 2);
+        if (inside && planes.players(to.cell)) { return {move_blocked, from}; }
+    }
+    if (!inside) { return {has_gold ? move_exit : move_off_map, from}; }
+    if (planes.is_wall(to.cell)) { return {move_blocked, from}; }
+
+    switch (planes.gold(to.cell)) {
+    case 0:
+        return {move_ok, to};
+    case G_GOLD:
+        return {move_found_gold, to};
+    case G_FOOL:
+        return {move_found_fools_gold, to};
+    default:
+        return {move_blocked, from};
+    }
+}
+
+/**
+ * @brief run the kernel specialized for a direction. The switch lets every kernel
+ *          inline into the caller, which an array of function pointers would not.
+ */
+inline move_result_S move_dispatch(DIRECTION_E direction, const Cell_planes &planes,
+                                   move_position_S from, bool has_gold) {
+    switch (direction) {
+    case dir_left:
+        return move_kernel<dir_left>(planes, from, has_gold);
+    case dir_down:
+        return move_kernel<dir_down>(planes, from, has_gold);
+    case dir_up:
+        return move_kernel<dir_up>(planes, from, has_gold);
+    case dir_right:
+        return move_kernel<dir_right>(planes, from, has_gold);
+    case dir_up_left:
+        return move_kernel<dir_up_left>(planes, from, has_gold);
+    case dir_up_right:
+        return move_kernel<dir_up_right>(planes, from, has_gold);
+    case dir_down_left:
+        return move_kernel<dir_down_left>(planes, from, has_gold);
+    case dir_down_right:
+        return move_kernel<dir_down_right>(planes, from, has_gold);
+    default:
+        return {move_blocked, from};
+    }
+}
+
+struct move_key_table_S {
+    unsigned char direction[128];
+
+    constexpr move_key_table_S() : direction() {
+        const char keys[dir_count + 1] = "hjklyubn"; // same order as DIRECTION_E
+        for (unsigned int i = 0; i < 128; ++i) { direction[i] = dir_none; }
+        for (unsigned int d = 0; d < dir_count; ++d) {
+            direction[(unsigned char)keys[d]]        = d;
+            direction[(unsigned char)keys[d] & ~0x20] = d; // upper case too
+        }
+    }
+};
+
+inline constexpr move_key_table_S move_key_table;
+
+/**
+ * @brief direction a key moves in, dir_none for anything that isn't a move key.
+ */
+inline DIRECTION_E direction_of_key(int key) {
+    return ((key >= 0) && (key < 128)) ? (DIRECTION_E)move_key_table.direction[key]
+                                       : dir_none;
+}
+
+#endif // __MOVE_KERNEL_H__
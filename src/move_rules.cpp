@@ -0,0 +1,66 @@
+/**
+ * @file move_rules.cpp
+ * @author Feras Alshehri (falshehri@mail.csuchico.edu)
+ * @brief the rules of a move, shared by the game and the session host: the move
+ *          kernel decides, and a legal move picks up any gold and is recorded
+ *          everywhere the game keeps track of players.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "move_rules.h"
+
+/**
+ * @brief move a player one step, if the move kernel finds it legal. Must be called
+ *          with the game semaphore held.
+ *
+ * @param game map and whatever else the game keeps.
+ * @param player the player's bit.
+ * @param direction where to.
+ * @param position where the player is, updated when they move.
+ * @param has_gold set once the player picks up the real gold.
+ * @return MOVE_OUTCOME_E what happened, for the caller to tell the player.
+ */
+MOVE_OUTCOME_E apply_move(move_context_S &game, unsigned char player, DIRECTION_E direction,
+                          move_position_S &position, bool &has_gold) {
+    move_result_S result = move_dispatch(direction, game.planes, position, has_gold);
+
+    switch (result.outcome) {
+    case move_exit:
+        return move_exit;
+
+    case move_blocked:
+        // fall through
+    case move_off_map:
+        if (game.metrics != nullptr) { metrics_add(game.metrics->rejected_moves); }
+        return result.outcome;
+
+    default:
+        break;
+    }
+
+    unsigned int  from  = position.cell;
+    unsigned int  to    = result.target.cell;
+    unsigned char found = game.planes.take_gold(to);
+
+    if (game.metrics != nullptr) {
+        metrics_add(game.metrics->moves);
+        if (found == G_GOLD) { metrics_add(game.metrics->real_gold_found); }
+        if (found == G_FOOL) { metrics_add(game.metrics->fools_gold_found); }
+    }
+    if (game.journal != nullptr) { game.journal->record(journal_move, player, from, to, found); }
+
+    game.planes.set_players(from, 0); // empty
+    game.planes.set_players(to, player);
+    if (game.spatial != nullptr) {
+        if (found != 0) { game.spatial->remove(to, found); }
+        game.spatial->move(from, to, player);
+    }
+
+    position = result.target;
+    if (result.outcome == move_found_gold) { has_gold = true; }
+    return result.outcome;
+}
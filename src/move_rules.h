@@ -0,0 +1,22 @@
+#ifndef __MOVE_RULES_H__
+#define __MOVE_RULES_H__
+
+#include "cell_planes.h"
+#include "game_metrics.h"
+#include "move_journal.h"
+#include "move_kernel.h"
+#include "spatial_index.h"
+
+// what a move touches besides the map. A game that doesn't keep one of them passes
+// nullptr for it.
+struct move_context_S {
+    Cell_planes       planes;
+    Spatial_index    *spatial;
+    Move_journal     *journal;
+    player_metrics_S *metrics; // the moving player's
+};
+
+MOVE_OUTCOME_E apply_move(move_context_S &game, unsigned char player, DIRECTION_E direction,
+                          move_position_S &position, bool &has_gold);
+
+#endif // __MOVE_RULES_H__
@@ -0,0 +1,234 @@
+/**
+ * @file path_finder.cpp
+ * @author Feras Alshehri (falshehri@mail.csuchico.edu)
+ * @brief multi-source BFS distance field used by bots and the in-game hint to find
+ *          the way to the nearest gold.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <algorithm>
+
+#include "goldchase.h"
+#include "path_finder.h"
+
+/**
+ * @brief build the padded passable grid from the map. Walls are static after
+ *          slurp_map() so this is only done once per map.
+ *
+ * @param planes map planes.
+ */
+Path_finder::Path_finder(const Cell_planes &planes) {
+    load_walls(planes);
+    rebuild(planes);
+}
+
+/**
+ * @brief same, with the gold given as a list of cells rather than read from the
+ *          planes, e.g. gathered under the game semaphore by a caller that builds
+ *          the field after giving it back.
+ *
+ * @param planes map planes, only the walls are read.
+ * @param gold map cell indices of the gold.
+ */
+Path_finder::Path_finder(const Cell_planes &planes, const std::vector<unsigned int> &gold) {
+    load_walls(planes);
+    for (unsigned int cell : gold) { add_gold(cell); }
+}
+
+Path_finder::~Path_finder() {}
+
+unsigned int Path_finder::to_padded(unsigned int cell) {
+    return (cell / cols + 1) * stride + (cell % cols) + 1;
+}
+
+void Path_finder::load_walls(const Cell_planes &planes) {
+    rows   = planes.get_rows();
+    cols   = planes.get_cols();
+    stride = cols + 2;
+
+    unsigned int padded_size = (rows + 2) * stride;
+    passable.assign(padded_size, 0);
+    dist.assign(padded_size, PATH_UNREACHABLE);
+    step.assign(padded_size, 0);
+    queue.resize(padded_size);
+    is_source.assign(padded_size, 0);
+    seen.assign(padded_size, 0);
+
+    for (unsigned int y = 0; y < rows; ++y) {
+        unsigned char *out = &passable[(y + 1) * stride + 1];
+        for (unsigned int x = 0; x < cols; ++x) { out[x] = !planes.is_wall(y * cols + x); }
+    }
+}
+
+/**
+ * @brief expand the frontier queue[head..tail) relaxing any neighbour whose
+ *          distance improves. Used for both the full rebuild and incremental adds.
+ *
+ * @param head index of the first queued cell.
+ * @param tail one past the last queued cell.
+ */
+void Path_finder::bfs(unsigned int head, unsigned int tail) {
+    // neighbour offset and the key that walks back from that neighbour to us
+    const int           offsets[4] = {-1, 1, -(int)stride, (int)stride};
+    const unsigned char back[4]    = {'l', 'h', 'j', 'k'};
+
+    while (head != tail) {
+        unsigned int u  = queue[head++];
+        unsigned int du = dist[u] + 1;
+
+        for (int d = 0; d < 4; ++d) {
+            unsigned int v = u + offsets[d];
+            if (passable[v] && du < dist[v]) {
+                dist[v]       = du;
+                step[v]       = back[d];
+                queue[tail++] = v;
+            }
+        }
+    }
+}
+
+/**
+ * @brief reload the gold from the gold set and recompute the whole distance field.
+ *
+ * @param planes map planes.
+ */
+void Path_finder::rebuild(const Cell_planes &planes) {
+    for (auto s : sources) { is_source[s] = 0; }
+    sources.clear();
+    for (const gold_entry_S &e : planes.get_gold_set().slots) {
+        if (e.kind != 0) {
+            sources.push_back(to_padded(e.key - 1));
+            is_source[sources.back()] = 1;
+        }
+    }
+
+    recompute();
+}
+
+/**
+ * @brief recompute the whole distance field from the current gold sources.
+ *
+ */
+void Path_finder::recompute() {
+    std::fill(dist.begin(), dist.end(), PATH_UNREACHABLE);
+    std::fill(step.begin(), step.end(), 0);
+
+    unsigned int tail = 0;
+    for (auto s : sources) {
+        dist[s]       = 0;
+        queue[tail++] = s;
+    }
+    bfs(0, tail);
+
+    dirty = false;
+}
+
+/**
+ * @brief register a new gold cell. Adding a source can only shorten distances, so
+ *          only the region now closer to this gold is revisited.
+ *
+ * @param cell map cell index of the new gold.
+ */
+void Path_finder::add_gold(unsigned int cell) {
+    unsigned int p = to_padded(cell);
+    if (is_source[p]) { return; }
+
+    sources.push_back(p);
+    is_source[p] = 1;
+    if (dirty || dist[p] == 0) { return; }
+
+    dist[p]  = 0;
+    step[p]  = 0;
+    queue[0] = p;
+    bfs(0, 1);
+}
+
+/**
+ * @brief unregister a gold cell (picked up). Removing a source can lengthen
+ *          distances anywhere, so the field is recomputed lazily on next query.
+ *
+ * @param cell map cell index of the removed gold.
+ */
+void Path_finder::remove_gold(unsigned int cell) {
+    unsigned int p = to_padded(cell);
+    if (!is_source[p]) { return; }
+
+    auto it      = std::find(sources.begin(), sources.end(), p);
+    is_source[p] = 0;
+    *it          = sources.back();
+    sources.pop_back();
+    dirty = true;
+}
+
+/**
+ * @brief bring the gold up to date with the gold now on the map, through add_gold()
+ *          and remove_gold(), so the field is only recomputed when gold went away.
+ *
+ * @param gold map cell indices of all the gold on the map.
+ */
+void Path_finder::update_gold(const std::vector<unsigned int> &gold) {
+    for (unsigned int cell : gold) { seen[to_padded(cell)] = 1; }
+
+    // picked up since the last update, walked backwards since removing reorders
+    for (size_t i = sources.size(); i-- > 0;) {
+        unsigned int p = sources[i];
+        if (!seen[p]) { remove_gold((p / stride - 1) * cols + (p % stride) - 1); }
+    }
+    for (unsigned int cell : gold) {
+        seen[to_padded(cell)] = 0;
+        add_gold(cell);
+    }
+}
+
+/**
+ * @brief number of hjkl steps from cell to the nearest gold.
+ *
+ * @param cell map cell index.
+ * @return unsigned int distance, or PATH_UNREACHABLE.
+ */
+unsigned int Path_finder::distance_to_gold(unsigned int cell) {
+    if (dirty) { recompute(); }
+    return dist[to_padded(cell)];
+}
+
+/**
+ * @brief key ('h', 'j', 'k' or 'l') that moves one step closer to the nearest gold.
+ *
+ * @param cell map cell index.
+ * @return int key, or 0 when standing on gold or no gold is reachable.
+ */
+int Path_finder::next_key(unsigned int cell) {
+    if (distance_to_gold(cell) == PATH_UNREACHABLE) { return 0; }
+    return step[to_padded(cell)];
+}
+
+/**
+ * @brief map cell one step closer to the nearest gold.
+ *
+ * @param cell map cell index.
+ * @param next set to the next cell on success.
+ * @return true if there is a step to take.
+ * @return false when standing on gold or no gold is reachable.
+ */
+bool Path_finder::next_step(unsigned int cell, unsigned int &next) {
+    switch (next_key(cell)) {
+    case int('h'):
+        next = cell - 1;
+        return true;
+    case int('l'):
+        next = cell + 1;
+        return true;
+    case int('k'):
+        next = cell - cols;
+        return true;
+    case int('j'):
+        next = cell + cols;
+        return true;
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef __PATH_FINDER_H__
+#define __PATH_FINDER_H__
+
+#include <vector>
+
+#include "cell_planes.h"
+
+#define PATH_UNREACHABLE 0xFFFFFFFFu
+
+/**
+ * @brief BFS distance field toward the nearest gold (real or fool's) over the
+ *          game map. Walls never change after slurp_map(), so the passable grid is
+ *          built once and only gold changes invalidate the field.
+ *
+ *        The grid is stored with a one cell wall border so neighbour lookups are
+ *        plain index offsets with no bounds checks.
+ */
+class Path_finder {
+  private:
+    unsigned int               rows   = 0;
+    unsigned int               cols   = 0;
+    unsigned int               stride = 0; // cols + 2 (padded row length)
+    std::vector<unsigned char> passable;   // padded, 0 = wall/border
+    std::vector<unsigned int>  dist;       // padded, steps to nearest gold
+    std::vector<unsigned char> step;       // padded, key toward nearest gold
+    std::vector<unsigned int>  queue;      // BFS frontier, reused between runs
+    std::vector<unsigned int>  sources;    // padded indices of gold cells
+    std::vector<unsigned char> is_source;  // padded, 1 = in sources
+    std::vector<unsigned char> seen;       // padded, scratch for update_gold()
+    bool                       dirty = true;
+
+    unsigned int to_padded(unsigned int cell);
+    void         load_walls(const Cell_planes &planes);
+    void         bfs(unsigned int head, unsigned int tail);
+    void         recompute();
+
+  public:
+    Path_finder(const Cell_planes &planes);
+    Path_finder(const Cell_planes &planes, const std::vector<unsigned int> &gold);
+    ~Path_finder();
+    void         rebuild(const Cell_planes &planes);
+    void         update_gold(const std::vector<unsigned int> &gold);
+    void         add_gold(unsigned int cell);
+    void         remove_gold(unsigned int cell);
+    unsigned int distance_to_gold(unsigned int cell);
+    int          next_key(unsigned int cell);
+    bool         next_step(unsigned int cell, unsigned int &next);
+};
+
+#endif // __PATH_FINDER_H__
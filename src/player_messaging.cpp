@@ -0,0 +1,198 @@
+/**
+ * @file player_messaging.cpp
+ * @author Feras Alshehri (falshehri@mail.csuchico.edu)
+ * @brief player to player and broadcast messages.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "goldchase.h"
+#include "player_messaging.h"
+
+/**
+ * @brief attach player's inbox. With message queues the queue is created here and
+ *          removed again by the destructor; with rings any message left over from a
+ *          previous player in this slot is dropped.
+ *
+ * @param t transport to use.
+ * @param r rings in the shared segment (ring transport only).
+ * @param p player number (1..5).
+ * @param prefix message queue name prefix.
+ */
+Player_messaging::Player_messaging(MESSAGE_TRANSPORT_E t, message_rings_S *r,
+                                   unsigned int p, std::string prefix)
+    : transport(t), rings(r), player(p), mq_prefix(prefix) {
+    if (transport == transport_mq) {
+        struct mq_attr attr = {};
+        attr.mq_maxmsg      = MSG_RING_SLOTS;
+        attr.mq_msgsize     = sizeof(message_S);
+        inbox = mq_open(queue_name(player).c_str(), O_CREAT | O_RDONLY | O_NONBLOCK,
+                        S_IRUSR | S_IWUSR, &attr);
+        // a player that crashed in this slot may have left its queue behind
+        message_S stale;
+        while ((inbox != (mqd_t)-1) &&
+               (mq_receive(inbox, (char *)&stale, sizeof(stale), nullptr) > 0)) {}
+    } else {
+        for (unsigned int from = 0; from < MSG_MAX_PLAYERS; ++from) {
+            message_ring_S &ring = rings->ring[from][player - 1];
+            __atomic_store_n(&ring.head, __atomic_load_n(&ring.tail, __ATOMIC_ACQUIRE),
+                             __ATOMIC_RELEASE);
+        }
+    }
+}
+
+Player_messaging::~Player_messaging() {
+    if (inbox != (mqd_t)-1) {
+        mq_close(inbox);
+        mq_unlink(queue_name(player).c_str());
+    }
+}
+
+bool Player_messaging::is_good() {
+    return (transport == transport_ring) ? (rings != nullptr) : (inbox != (mqd_t)-1);
+}
+
+std::string Player_messaging::queue_name(unsigned int p) {
+    return mq_prefix + std::to_string(p);
+}
+
+/**
+ * @brief send a message to one player.
+ *
+ * @param to receiving player number (1..5).
+ * @param text message text, truncated to MSG_TEXT_MAX characters.
+ * @return true if the message was queued, false if the player's inbox is full or
+ * gone.
+ */
+bool Player_messaging::send(unsigned int to, const std::string &text) {
+    message_S msg;
+
+    if ((to < 1) || (to > MSG_MAX_PLAYERS)) { return false; }
+
+    msg.from   = player;
+    msg.length = std::min(text.size(), (size_t)MSG_TEXT_MAX);
+    std::memcpy(msg.text, text.data(), msg.length);
+
+    if (transport == transport_ring) { return ring_send(to, msg); }
+
+    mqd_t q = mq_open(queue_name(to).c_str(), O_WRONLY | O_NONBLOCK);
+    if (q == (mqd_t)-1) { return false; }
+    bool ok = (mq_send(q, (const char *)&msg, sizeof(msg), 0) == 0);
+    mq_close(q);
+    return ok;
+}
+
+/**
+ * @brief send a message to every other active player.
+ *
+ * @param player_mask gmp->players.
+ * @param text message text.
+ * @return true if every active player got it.
+ */
+bool Player_messaging::broadcast(unsigned char player_mask, const std::string &text) {
+    bool ok = true;
+    for (unsigned int p = 1; p <= MSG_MAX_PLAYERS; ++p) {
+        if ((p != player) && (player_mask & (G_PLR0 << (p - 1)))) {
+            ok = send(p, text) && ok;
+        }
+    }
+    return ok;
+}
+
+/**
+ * @brief take the next message out of our inbox.
+ *
+ * @param msg set to the message on success.
+ * @param timeout_ms how long to wait for one, 0 = don't wait.
+ * @return true if a message was received.
+ */
+bool Player_messaging::receive(message_S &msg, int timeout_ms) {
+    struct timespec ts;
+
+    if (transport == transport_mq) {
+        if (timeout_ms == 0) {
+            return mq_receive(inbox, (char *)&msg, sizeof(msg), nullptr) == sizeof(msg);
+        }
+        // the inbox is non-blocking, so wait for it explicitly
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_sec += timeout_ms / 1000;
+        ts.tv_nsec += (timeout_ms % 1000) * 1000000L;
+        if (ts.tv_nsec >= 1000000000L) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000L;
+        }
+        struct mq_attr attr, blocking = {};
+        mq_setattr(inbox, &blocking, &attr);
+        bool ok = mq_timedreceive(inbox, (char *)&msg, sizeof(msg), nullptr, &ts) ==
+                  sizeof(msg);
+        mq_setattr(inbox, &attr, nullptr);
+        return ok;
+    }
+
+    if (ring_receive(msg)) { return true; }
+    if (timeout_ms == 0) { return false; }
+
+    // read the doorbell before looking again, so a send in between makes the futex
+    // wait return at once instead of sleeping through it
+    uint32_t bell = __atomic_load_n(&rings->doorbell[player - 1], __ATOMIC_ACQUIRE);
+    if (ring_receive(msg)) { return true; }
+    ts.tv_sec  = timeout_ms / 1000;
+    ts.tv_nsec = (timeout_ms % 1000) * 1000000L;
+    syscall(SYS_futex, &rings->doorbell[player - 1], FUTEX_WAIT, bell, &ts, nullptr, 0);
+    return ring_receive(msg);
+}
+
+/**
+ * @brief push a message into our ring to the receiver and ring its doorbell.
+ */
+bool Player_messaging::ring_send(unsigned int to, const message_S &msg) {
+    message_ring_S &ring = rings->ring[player - 1][to - 1];
+    uint32_t        tail = ring.tail; // only we write it
+    uint32_t        head = __atomic_load_n(&ring.head, __ATOMIC_ACQUIRE);
+
+    if (tail - head >= MSG_RING_SLOTS) { return false; }
+
+    ring.slots[tail % MSG_RING_SLOTS] = msg;
+    __atomic_store_n(&ring.tail, tail + 1, __ATOMIC_RELEASE);
+
+    __atomic_add_fetch(&rings->doorbell[to - 1], 1, __ATOMIC_RELEASE);
+    syscall(SYS_futex, &rings->doorbell[to - 1], FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    return true;
+}
+
+/**
+ * @brief pop the oldest message from any of the rings addressed to us.
+ */
+bool Player_messaging::ring_receive(message_S &msg) {
+    for (unsigned int from = 0; from < MSG_MAX_PLAYERS; ++from) {
+        message_ring_S &ring = rings->ring[from][player - 1];
+        uint32_t        head = ring.head; // only we write it
+        if (head == __atomic_load_n(&ring.tail, __ATOMIC_ACQUIRE)) { continue; }
+
+        msg = ring.slots[head % MSG_RING_SLOTS];
+        __atomic_store_n(&ring.head, head + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief transport chosen by GOLDCHASE_MSG, rings unless it says "mq".
+ */
+MESSAGE_TRANSPORT_E message_transport_from_env() {
+    const char *env = getenv(MSG_TRANSPORT_ENV);
+    return (env != nullptr && std::string(env) == "mq") ? transport_mq : transport_ring;
+}
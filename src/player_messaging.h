@@ -0,0 +1,65 @@
+#ifndef __PLAYER_MESSAGING_H__
+#define __PLAYER_MESSAGING_H__
+
+#include <mqueue.h>
+#include <stdint.h>
+#include <string>
+
+#define MSG_QUEUE_PREFIX "/goldchase_mq_player" // + player number (1..5)
+#define MSG_TRANSPORT_ENV "GOLDCHASE_MSG"        // "mq" or "ring" (default)
+#define MSG_RING_SLOTS 8
+#define MSG_MAX_PLAYERS 5
+#define MSG_TEXT_MAX 126
+
+// one message, exactly two cache lines
+struct message_S {
+    uint8_t from; // sender's player number (1..5)
+    uint8_t length;
+    char    text[MSG_TEXT_MAX];
+};
+
+// single producer / single consumer ring of one (sender, receiver) pair
+struct alignas(64) message_ring_S {
+    alignas(64) uint32_t head; // next slot to read, written by the receiver only
+    alignas(64) uint32_t tail; // next slot to write, written by the sender only
+    message_S slots[MSG_RING_SLOTS];
+};
+
+// every sender has its own ring to every receiver, so no ring ever has more than
+// one writer and no lock is needed
+struct message_rings_S {
+    message_ring_S ring[MSG_MAX_PLAYERS][MSG_MAX_PLAYERS]; // [from - 1][to - 1]
+    alignas(64) uint32_t doorbell[MSG_MAX_PLAYERS];        // futex word per receiver
+};
+
+enum MESSAGE_TRANSPORT_E { transport_mq, transport_ring };
+
+/**
+ * @brief player to player messaging over either one POSIX message queue per player
+ *          slot, or the lock-free rings in the shared segment.
+ */
+class Player_messaging {
+  private:
+    MESSAGE_TRANSPORT_E transport;
+    message_rings_S    *rings;
+    unsigned int        player; // 1..5
+    std::string         mq_prefix;
+    mqd_t               inbox = (mqd_t)-1;
+
+    std::string queue_name(unsigned int p);
+    bool        ring_send(unsigned int to, const message_S &msg);
+    bool        ring_receive(message_S &msg);
+
+  public:
+    Player_messaging(MESSAGE_TRANSPORT_E transport, message_rings_S *rings,
+                     unsigned int player, std::string mq_prefix = MSG_QUEUE_PREFIX);
+    ~Player_messaging();
+    bool is_good();
+    bool send(unsigned int to, const std::string &text);
+    bool broadcast(unsigned char player_mask, const std::string &text);
+    bool receive(message_S &msg, int timeout_ms = 0);
+};
+
+MESSAGE_TRANSPORT_E message_transport_from_env();
+
+#endif // __PLAYER_MESSAGING_H__
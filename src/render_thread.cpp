@@ -0,0 +1,139 @@
+/**
+ * @file render_thread.cpp
+ * @author Feras Alshehri (falshehri@mail.csuchico.edu)
+ * @brief render thread of a player process, drawing double buffered snapshots of the
+ *          map at a capped frame rate.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "render_thread.h"
+#include "trace.h"
+
+/**
+ * @brief Construct a new Render_thread object and start the thread. The map was
+ *          drawn once already, by its constructor.
+ *
+ * @param map map to draw, constructed from the live planes.
+ * @param live planes in the game segment, the walls are copied once here.
+ * @param fov line of sight under fog of war, nullptr to draw the whole map.
+ * @param fps frames drawn per second at most, 0 for no cap.
+ * @param metrics this player's metrics slot.
+ */
+Render_thread::Render_thread(Map &map, const Cell_planes &live, Field_of_view *fov,
+                             unsigned int fps, player_metrics_S &metrics)
+    : map(map), fov(fov), metrics(metrics),
+      period(fps ? std::chrono::microseconds(1000000 / fps) : std::chrono::microseconds(0)) {
+    for (auto &buffer : buffers) {
+        buffer.reset(new Cell_planes_buffer(live.get_rows(), live.get_cols()));
+        for (unsigned int i = 0; i < live.get_cells(); ++i) {
+            if (live.is_wall(i)) { buffer->planes().set_wall(i); }
+        }
+    }
+    thread = std::thread(&Render_thread::run, this);
+}
+
+/**
+ * @brief stop the thread, dropping whatever was not drawn yet.
+ */
+Render_thread::~Render_thread() {
+    {
+        std::lock_guard<std::mutex> lock(frame_lock);
+        stopping = true;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+/**
+ * @brief hand a snapshot of the map to the render thread. Reads the game segment
+ *          without the semaphore, as drawing it directly always did; a frame
+ *          caught halfway through someone's move is put right by the next one.
+ *
+ * @param live planes in the game segment.
+ * @param viewer_cell where our player is, for the fog of war.
+ */
+void Render_thread::publish(const Cell_planes &live, unsigned int viewer_cell) {
+    {
+        std::lock_guard<std::mutex> lock(frame_lock);
+        buffers[back]->planes().copy_changing(live);
+        viewer[back] = viewer_cell;
+        if (pending) { metrics_add(metrics.frames_dropped); }
+        pending = true;
+    }
+    wake.notify_one();
+}
+
+/**
+ * @brief show a toast, from any thread.
+ *
+ * @param msg toast text.
+ */
+void Render_thread::post_toast(const std::string &msg) {
+    {
+        std::lock_guard<std::mutex> lock(frame_lock);
+        toasts.push_back(msg);
+    }
+    wake.notify_one();
+}
+
+/**
+ * @brief keep the render thread off the screen while the caller uses ncurses
+ *          itself, e.g. for a dialog. It resumes once the lock goes away.
+ *
+ * @return std::unique_lock<std::mutex> lock on the screen.
+ */
+std::unique_lock<std::mutex> Render_thread::hold_screen() {
+    return std::unique_lock<std::mutex>(screen_lock);
+}
+
+/**
+ * @brief the render thread: wait for a snapshot or a toast, flip the buffers and
+ *          draw. After a frame it waits out the rest of the frame period, and
+ *          snapshots published meanwhile replace each other.
+ */
+void Render_thread::run() {
+    auto next_frame = std::chrono::steady_clock::now();
+
+    while (true) {
+        std::vector<std::string> new_toasts;
+        int                      front = -1;
+        {
+            std::unique_lock<std::mutex> lock(frame_lock);
+            wake.wait_for(lock, std::chrono::milliseconds(RENDER_TOAST_POLL_MS),
+                          [this] { return pending || !toasts.empty() || stopping; });
+            if (pending) {
+                wake.wait_until(lock, next_frame, [this] { return stopping; });
+            }
+            if (stopping) { return; }
+
+            if (pending) {
+                front      = back;
+                back       = 1 - back;
+                pending    = false;
+                next_frame = std::chrono::steady_clock::now() + period;
+            }
+            new_toasts.swap(toasts);
+        }
+
+        std::lock_guard<std::mutex> screen(screen_lock);
+        for (const std::string &msg : new_toasts) { map.postToast(msg.c_str()); }
+        map.updateToasts();
+        if (front < 0) { continue; }
+
+        TRACE_BEGIN("render");
+        map.setPlanes(buffers[front]->planes());
+        if (fov != nullptr) {
+            map.drawVisible(fov->visible_from(viewer[front]));
+        } else {
+            map.drawChanges();
+        }
+        TRACE_END("render");
+        metrics_add(metrics.frames_drawn);
+        metrics_set(metrics.cells_plotted, map.getPlotCount());
+        metrics_set(metrics.bytes_written, map.getBytesWritten());
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef __RENDER_THREAD_H__
+#define __RENDER_THREAD_H__
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Map.h"
+#include "cell_planes.h"
+#include "field_of_view.h"
+#include "game_metrics.h"
+
+#define RENDER_FPS_ENV "GOLDCHASE_FPS" // frame rate cap of the render thread
+#define RENDER_DEFAULT_FPS 30
+#define RENDER_TOAST_POLL_MS 100 // toasts expire on time even when no frame comes
+
+/**
+ * @brief draws the map on a thread of its own, so a slow terminal never holds up
+ *          the thread reading keys and committing moves.
+ *
+ *        The input thread publishes snapshots of the map into the back one of two
+ *        buffers; the render thread flips the buffers and draws the front one, at
+ *        most fps times a second. A snapshot published before the previous one was
+ *        drawn replaces it, and the replaced frame is counted as dropped.
+ *
+ *        The render thread is the only one touching ncurses; anything else that
+ *        needs the screen (dialogs) holds it with hold_screen() meanwhile.
+ */
+class Render_thread {
+  private:
+    Map                &map;
+    Field_of_view      *fov;
+    player_metrics_S   &metrics;
+    std::chrono::microseconds period;
+
+    std::unique_ptr<Cell_planes_buffer> buffers[2];
+    unsigned int                        viewer[2] = {0, 0}; // player cell, for the fog
+    int                                 back      = 0; // the one publish() writes to
+    bool                                pending   = false;
+    std::vector<std::string>            toasts;
+    bool                                stopping  = false;
+    std::mutex                          frame_lock; // guards the members above
+    std::condition_variable             wake;
+
+    std::mutex  screen_lock; // held by whoever is using ncurses
+    std::thread thread;
+
+    void run();
+
+  public:
+    Render_thread(Map &map, const Cell_planes &live, Field_of_view *fov, unsigned int fps,
+                  player_metrics_S &metrics);
+    ~Render_thread();
+
+    void                         publish(const Cell_planes &live, unsigned int viewer_cell);
+    void                         post_toast(const std::string &msg);
+    std::unique_lock<std::mutex> hold_screen();
+    Map                         &get_map() { return map; }
+};
+
+#endif // __RENDER_THREAD_H__
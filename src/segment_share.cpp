@@ -0,0 +1,290 @@
+/**
+ * @file segment_share.cpp
+ * @author Feras Alshehri (falshehri@mail.csuchico.edu)
+ * @brief sharing the game segment as sealed memfds handed over a unix socket,
+ *          instead of by name in /dev/shm.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "segment_share.h"
+#include "shared_segment.h"
+
+#define SYSCALL_OK 0
+
+/**
+ * @brief whether the game is shared by passing fds, see SHARE_ENV.
+ */
+bool share_by_fd_from_env() {
+    const char *mode = getenv(SHARE_ENV);
+    return mode && (strcmp(mode, "memfd") == 0);
+}
+
+/**
+ * @brief the abstract socket address: a leading 0 byte keeps it out of the file
+ *          system, and it goes away with the last socket bound to it. The name
+ *          carries the uid so another user holding it can't keep anyone from
+ *          playing.
+ */
+static socklen_t share_address(sockaddr_un &addr) {
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    int length = snprintf(addr.sun_path + 1, sizeof(addr.sun_path) - 1, "%s.%u",
+                          SHARE_SOCKET_NAME, (unsigned int)getuid());
+    return offsetof(sockaddr_un, sun_path) + 1 + length;
+}
+
+/**
+ * @brief whether the other end of a unix socket runs as this user. The abstract
+ *          name has no permissions of its own.
+ */
+static bool share_peer_is_us(int sock) {
+    ucred     peer;
+    socklen_t length = sizeof(peer);
+    return (getsockopt(sock, SOL_SOCKET, SO_PEERCRED, &peer, &length) == SYSCALL_OK) &&
+           (peer.uid == getuid());
+}
+
+/**
+ * @brief whether received fds are what share_create_segment() and
+ *          share_seal_walls() make: sealed so they can't change size (or the
+ *          walls content) under us, and as large as the map in the segment's
+ *          header says they have to be, so nothing is mapped past their end.
+ */
+static bool share_fds_valid(const int fds[SHARE_FDS]) {
+    int segment_seals = fcntl(fds[0], F_GET_SEALS);
+    int walls_seals   = fcntl(fds[1], F_GET_SEALS);
+    if ((segment_seals < 0) || ((segment_seals & SHARE_SEGMENT_SEALS) != SHARE_SEGMENT_SEALS) ||
+        (walls_seals < 0) || ((walls_seals & SHARE_WALLS_SEALS) != SHARE_WALLS_SEALS)) {
+        return false;
+    }
+
+    goldMine_S  header;
+    struct stat segment, walls;
+    if ((pread(fds[0], &header, sizeof(header), 0) != (ssize_t)sizeof(header)) ||
+        (fstat(fds[0], &segment) != SYSCALL_OK) || (fstat(fds[1], &walls) != SYSCALL_OK)) {
+        return false;
+    }
+    size_t walls_length = goldmine_arena_offset(header.rows, header.cols) -
+                          goldmine_walls_offset(header.rows, header.cols);
+    return (header.rows > 0) && (header.cols > 0) &&
+           ((size_t)segment.st_size == goldmine_reserve_size(header.rows, header.cols)) &&
+           ((size_t)walls.st_size >= walls_length);
+}
+
+/**
+ * @brief create the segment as a memfd. It is sized to the arena's limit up
+ *          front, sparse, and sealed so it can neither grow nor shrink: the arena
+ *          backs pages within that size with posix_fallocate(), and no process
+ *          can truncate the segment from under the others.
+ *
+ * @param reserve size the segment may grow to, see goldmine_reserve_size().
+ * @return int the fd, -1 on failure.
+ */
+int share_create_segment(size_t reserve) {
+    int fd = memfd_create("goldchase_segment", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0) { return -1; }
+
+    if ((ftruncate(fd, reserve) != SYSCALL_OK) ||
+        (fcntl(fd, F_ADD_SEALS, SHARE_SEGMENT_SEALS) != SYSCALL_OK)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief map the sealed wall plane over the segment's wall pages, read only.
+ *
+ * @param gmp the segment, mapped up to its reserve.
+ * @param walls_fd from share_seal_walls().
+ * @return false if the mapping failed; the segment's own wall pages stay.
+ */
+bool share_map_walls(goldMine_S *gmp, int walls_fd) {
+    size_t offset = goldmine_walls_offset(gmp->rows, gmp->cols);
+    size_t length = goldmine_arena_offset(gmp->rows, gmp->cols) - offset;
+    return mmap((char *)gmp + offset, length, PROT_READ, MAP_SHARED | MAP_FIXED, walls_fd,
+                0) != MAP_FAILED;
+}
+
+/**
+ * @brief move the wall plane, once the map is loaded, into a memfd of its own
+ *          sealed against writes, and map it over the segment's wall pages. Unlike
+ *          goldmine_protect_walls(), which every process applies to its own
+ *          mapping, no process can map these pages writable again.
+ *
+ * @param gmp the segment, walls loaded.
+ * @return int the fd of the wall plane, -1 on failure.
+ */
+int share_seal_walls(goldMine_S *gmp) {
+    size_t offset = goldmine_walls_offset(gmp->rows, gmp->cols);
+    size_t length = goldmine_arena_offset(gmp->rows, gmp->cols) - offset;
+
+    int fd = memfd_create("goldchase_walls", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0) { return -1; }
+
+    if ((pwrite(fd, (char *)gmp + offset, length, 0) != (ssize_t)length) ||
+        (fcntl(fd, F_ADD_SEALS, SHARE_WALLS_SEALS) != SYSCALL_OK) ||
+        !share_map_walls(gmp, fd)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief take the socket name. Binding is what elects the process serving
+ *          joiners: only one socket can hold the name.
+ *
+ * @return int listening socket, -1 with errno EADDRINUSE if another process holds
+ * the name.
+ */
+int share_listen() {
+    int sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (sock < 0) { return -1; }
+
+    sockaddr_un addr;
+    socklen_t   length = share_address(addr);
+    if ((bind(sock, (sockaddr *)&addr, length) != SYSCALL_OK) ||
+        (listen(sock, MAX_NUM_PLAYERS) != SYSCALL_OK)) {
+        int saved = errno;
+        close(sock);
+        errno = saved;
+        return -1;
+    }
+    return sock;
+}
+
+/**
+ * @brief get the game's fds from the process serving them: one connect() and one
+ *          recvmsg(), no name lookups. The fds are only taken from a process of
+ *          this user, and only if they are sealed as a game's are.
+ *
+ * @param fds out, the segment then the wall plane.
+ * @return false if no game is served, or not one to trust.
+ */
+bool share_receive(int fds[SHARE_FDS]) {
+    int sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (sock < 0) { return false; }
+
+    sockaddr_un addr;
+    socklen_t   length = share_address(addr);
+    if ((connect(sock, (sockaddr *)&addr, length) != SYSCALL_OK) || !share_peer_is_us(sock)) {
+        close(sock);
+        return false;
+    }
+
+    char    byte;
+    iovec   iov = {&byte, 1};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * SHARE_FDS)];
+    msghdr  msg     = {};
+    msg.msg_iov        = &iov;
+    msg.msg_iovlen     = 1;
+    msg.msg_control    = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t  got  = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+    cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    close(sock);
+    if ((got != 1) || !cmsg || (cmsg->cmsg_level != SOL_SOCKET) ||
+        (cmsg->cmsg_type != SCM_RIGHTS) ||
+        (cmsg->cmsg_len != CMSG_LEN(sizeof(int) * SHARE_FDS))) {
+        return false;
+    }
+    memcpy(fds, CMSG_DATA(cmsg), sizeof(int) * SHARE_FDS);
+    if (!share_fds_valid(fds)) {
+        for (int i = 0; i < SHARE_FDS; ++i) { close(fds[i]); }
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief start serving the game's fds.
+ *
+ * @param game_fds the segment then the wall plane, duplicated; the caller keeps
+ * its own.
+ * @param listen_fd a socket from share_listen() if this process already holds the
+ * name, -1 to keep trying to take it.
+ */
+Share_server::Share_server(const int game_fds[SHARE_FDS], int listen_fd)
+    : listen_fd(listen_fd), stop_fd(eventfd(0, EFD_CLOEXEC)) {
+    for (int i = 0; i < SHARE_FDS; ++i) { fds[i] = fcntl(game_fds[i], F_DUPFD_CLOEXEC, 0); }
+    thread = std::thread(&Share_server::run, this);
+}
+
+/**
+ * @brief stop serving, and give the name up for the other players to take.
+ */
+Share_server::~Share_server() {
+    uint64_t one = 1;
+    if (write(stop_fd, &one, sizeof(one)) != sizeof(one)) {}
+    thread.join();
+
+    if (listen_fd >= 0) { close(listen_fd); }
+    for (int i = 0; i < SHARE_FDS; ++i) { close(fds[i]); }
+    close(stop_fd);
+}
+
+/**
+ * @brief send the fds to one joiner, if it runs as the same user.
+ */
+void Share_server::serve(int client) {
+    if (!share_peer_is_us(client)) { return; }
+
+    char  byte = 0;
+    iovec iov  = {&byte, 1};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * SHARE_FDS)] = {};
+    msghdr msg         = {};
+    msg.msg_iov        = &iov;
+    msg.msg_iovlen     = 1;
+    msg.msg_control    = control;
+    msg.msg_controllen = sizeof(control);
+
+    cmsghdr *cmsg    = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type  = SCM_RIGHTS;
+    cmsg->cmsg_len   = CMSG_LEN(sizeof(int) * SHARE_FDS);
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * SHARE_FDS);
+    sendmsg(client, &msg, MSG_NOSIGNAL);
+}
+
+/**
+ * @brief serve joiners while holding the name, otherwise try to take it every
+ *          SHARE_RETRY_MS, until stopped.
+ */
+void Share_server::run() {
+    while (true) {
+        if (listen_fd < 0) { listen_fd = share_listen(); }
+
+        pollfd fds_polled[2] = {{stop_fd, POLLIN, 0}, {listen_fd, POLLIN, 0}};
+        int    ready = poll(fds_polled, (listen_fd < 0) ? 1 : 2,
+                            (listen_fd < 0) ? SHARE_RETRY_MS : -1);
+        if ((ready < 0) && (errno != EINTR)) { return; }
+        if (fds_polled[0].revents & POLLIN) { return; }
+
+        if ((listen_fd >= 0) && (fds_polled[1].revents & POLLIN)) {
+            int client = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client >= 0) {
+                serve(client);
+                close(client);
+            }
+        }
+    }
+}
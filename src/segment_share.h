@@ -0,0 +1,49 @@
+#ifndef __SEGMENT_SHARE_H__
+#define __SEGMENT_SHARE_H__
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <thread>
+
+#include "mine_entrance.h"
+
+#define SHARE_ENV "GOLDCHASE_SHARE"   // "memfd" shares the game by passing fds
+#define SHARE_SOCKET_NAME "goldchase" // abstract unix socket, the user's uid is appended
+#define SHARE_RETRY_MS 1000           // players try to take over serving joiners this often
+#define SHARE_FDS 2                   // the segment, then the wall plane
+
+// seals the fds must carry to be accepted, see share_create_segment() and
+// share_seal_walls()
+#define SHARE_SEGMENT_SEALS (F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL)
+#define SHARE_WALLS_SEALS (F_SEAL_WRITE | F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL)
+
+bool share_by_fd_from_env();
+int  share_create_segment(size_t reserve);
+int  share_seal_walls(goldMine_S *gmp);
+bool share_map_walls(goldMine_S *gmp, int walls_fd);
+int  share_listen();
+bool share_receive(int fds[SHARE_FDS]);
+
+/**
+ * @brief hands the game's fds to whoever connects to the abstract socket, from a
+ *          thread of each player process. Only one process can own the socket
+ *          name; the others keep trying, so when the one serving leaves the game
+ *          another takes over. Each user has a name of their own, and only
+ *          processes of the same user are served.
+ */
+class Share_server {
+  private:
+    int         fds[SHARE_FDS];
+    int         listen_fd;
+    int         stop_fd; // eventfd, wakes the thread to stop
+    std::thread thread;
+
+    void run();
+    void serve(int client);
+
+  public:
+    Share_server(const int game_fds[SHARE_FDS], int listen_fd = -1);
+    ~Share_server();
+};
+
+#endif // __SEGMENT_SHARE_H__
@@ -0,0 +1,236 @@
+/**
+ * @file shared_segment.cpp
+ * @author Feras Alshehri (falshehri@mail.csuchico.edu)
+ * @brief helpers to size and map the shared game segment, used by the game and by
+ *          the tools that attach to a running game.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <climits>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "shared_segment.h"
+
+/**
+ * @brief size of a new shared game segment for a map. The arena at its end may grow
+ *          it later, see goldmine_used_size().
+ *
+ * @param rows map rows.
+ * @param cols map cols.
+ * @return size_t segment size in bytes.
+ */
+size_t goldmine_segment_size(unsigned int rows, unsigned int cols) {
+    return goldmine_arena_offset(rows, cols) + GOLDMINE_ARENA_INITIAL;
+}
+
+/**
+ * @brief how much of the address space a segment for a map may take once its arena
+ *          has grown all it can. Processes map this much when they attach.
+ *
+ * @param rows map rows.
+ * @param cols map cols.
+ * @return size_t size in bytes.
+ */
+size_t goldmine_reserve_size(unsigned int rows, unsigned int cols) {
+    return goldmine_arena_offset(rows, cols) + GOLDMINE_ARENA_RESERVE;
+}
+
+/**
+ * @brief size of a segment as it is now, which is what a snapshot has to copy.
+ *
+ * @param gmp mapped segment.
+ * @return size_t segment size in bytes.
+ */
+size_t goldmine_used_size(const goldMine_S *gmp) {
+    return __atomic_load_n(&gmp->arena.end, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief bytes of the arena handed out so far, free blocks included.
+ *
+ * @param gmp mapped segment.
+ * @return size_t bytes.
+ */
+size_t goldmine_arena_used(const goldMine_S *gmp) {
+    return __atomic_load_n(&gmp->arena.top, __ATOMIC_RELAXED) - gmp->arena.begin;
+}
+
+/**
+ * @brief offset of the wall bitset in the segment. It starts on a page of its own
+ *          so it can be write protected apart from the rest of the segment.
+ *
+ * @param rows map rows.
+ * @param cols map cols.
+ * @return size_t offset in bytes.
+ */
+size_t goldmine_walls_offset(unsigned int rows, unsigned int cols) {
+    size_t page = sysconf(_SC_PAGESIZE);
+    return (sizeof(goldMine_S) + (size_t)rows * cols + page - 1) / page * page;
+}
+
+/**
+ * @brief offset of the arena in the segment, on the page after the walls.
+ *
+ * @param rows map rows.
+ * @param cols map cols.
+ * @return size_t offset in bytes.
+ */
+size_t goldmine_arena_offset(unsigned int rows, unsigned int cols) {
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t end  = goldmine_walls_offset(rows, cols) +
+                 cell_planes_wall_words(rows, cols) * sizeof(uint64_t);
+    return (end + page - 1) / page * page;
+}
+
+/**
+ * @brief the map planes of a mapped segment.
+ *
+ * @param gmp mapped segment.
+ * @return Cell_planes view of its walls, occupancy and gold.
+ */
+Cell_planes goldmine_planes(goldMine_S *gmp) {
+    uint64_t *walls = (uint64_t *)((char *)gmp + goldmine_walls_offset(gmp->rows, gmp->cols));
+    return Cell_planes(walls, gmp->occupancy, &gmp->gold, gmp->rows, gmp->cols);
+}
+
+/**
+ * @brief the arena of a mapped segment.
+ *
+ * @param gmp mapped segment.
+ * @param fd the segment's shm fd, to grow it; -1 when only reading.
+ * @return Shm_arena view of the arena.
+ */
+Shm_arena goldmine_arena(goldMine_S *gmp, int fd) { return Shm_arena(gmp, &gmp->arena, fd); }
+
+/**
+ * @brief set up the arena of a new segment, sized with goldmine_segment_size(), and
+ *          allocate the structures that live in it. Called by the first player once
+ *          rows and cols are set and the gold is placed: the spatial index is sized
+ *          for that gold and the players.
+ *
+ * @param gmp new segment.
+ * @param fd the segment's shm fd.
+ * @return false if the arena could not hold them.
+ */
+bool goldmine_format(goldMine_S *gmp, int fd) {
+    Shm_arena arena = goldmine_arena(gmp, fd);
+    arena.format(goldmine_arena_offset(gmp->rows, gmp->cols),
+                 goldmine_segment_size(gmp->rows, gmp->cols),
+                 goldmine_reserve_size(gmp->rows, gmp->cols));
+    uint32_t entities = gmp->gold.count + SPATIAL_MAX_PLAYERS;
+    gmp->spatial      = arena.allocate(spatial_index_bytes(entities));
+    gmp->timers       = arena.allocate(timer_wheel_bytes(GOLDMINE_TIMERS));
+    if (gmp->spatial != 0) { goldmine_spatial(gmp).format(entities); }
+    if (gmp->timers != 0) { goldmine_timers(gmp).format(GOLDMINE_TIMERS, 0); }
+    return (gmp->spatial != 0) && (gmp->timers != 0);
+}
+
+/**
+ * @brief the spatial index of a mapped segment.
+ *
+ * @param gmp mapped segment.
+ * @return Spatial_index view of its players and gold.
+ */
+Spatial_index goldmine_spatial(goldMine_S *gmp) {
+    return Spatial_index(goldmine_arena(gmp).at<spatial_index_S>(gmp->spatial), gmp->rows,
+                         gmp->cols);
+}
+
+/**
+ * @brief the timer wheel of a mapped segment, ticking in GAME_TICK_MS.
+ *
+ * @param gmp mapped segment.
+ * @return Timer_wheel view of the game's timers.
+ */
+Timer_wheel goldmine_timers(goldMine_S *gmp) {
+    return Timer_wheel(goldmine_arena(gmp).at<timer_wheel_S>(gmp->timers));
+}
+
+/**
+ * @brief make the wall bitset read only in this process. Walls never change once
+ *          the map is loaded, so a stray write into them faults instead of
+ *          silently corrupting the map for everyone.
+ *
+ * @param gmp mapped segment.
+ * @return true on success.
+ */
+bool goldmine_protect_walls(goldMine_S *gmp) {
+    size_t offset = goldmine_walls_offset(gmp->rows, gmp->cols);
+    size_t length = goldmine_arena_offset(gmp->rows, gmp->cols) - offset;
+    return mprotect((char *)gmp + offset, length, PROT_READ) == 0;
+}
+
+/**
+ * @brief map an existing game segment. The header is mapped first to learn the map
+ *          size, then the segment is mapped with all the room its arena may grow
+ *          into, so growing it never needs a remap. The walls are always mapped
+ *          read only.
+ *
+ * @param fd shared memory file descriptor.
+ * @param prot PROT_READ or PROT_READ | PROT_WRITE.
+ * @param segment_size set to the size of the mapping on success, see
+ * goldmine_used_size() for how much of it is in use.
+ * @return goldMine_S* mapped segment, or MAP_FAILED.
+ */
+goldMine_S *goldmine_attach(int fd, int prot, size_t &segment_size) {
+    goldMine_S *header =
+        (goldMine_S *)mmap(nullptr, sizeof(goldMine_S), PROT_READ, MAP_SHARED, fd, 0);
+    if (header == MAP_FAILED) { return (goldMine_S *)MAP_FAILED; }
+
+    segment_size = goldmine_reserve_size(header->rows, header->cols);
+    munmap(header, sizeof(goldMine_S));
+
+    goldMine_S *gmp = (goldMine_S *)mmap(nullptr, segment_size, prot, MAP_SHARED, fd, 0);
+    if ((gmp != MAP_FAILED) && (prot & PROT_WRITE)) { goldmine_protect_walls(gmp); }
+    return gmp;
+}
+
+void goldmine_detach(goldMine_S *gmp, size_t segment_size) { munmap(gmp, segment_size); }
+
+/**
+ * @brief note that the map changed. Called by players with the semaphore held,
+ *          after mutating the map; the watchers are woken by
+ *          goldmine_wake_watchers() once it is given back.
+ *
+ * @param gmp mapped game segment.
+ */
+void goldmine_publish_change(goldMine_S *gmp) {
+    __atomic_add_fetch(&gmp->generation, 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief wake anyone watching the map (spectators) after goldmine_publish_change().
+ *          Waking many of them takes a while, so it is kept out of the critical
+ *          section.
+ *
+ * @param gmp mapped game segment.
+ */
+void goldmine_wake_watchers(goldMine_S *gmp) {
+    syscall(SYS_futex, &gmp->generation, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+/**
+ * @brief sleep until the map generation differs from seen, or timeout. Only reads
+ *          the segment, so it works on a PROT_READ mapping.
+ *
+ * @param gmp mapped game segment.
+ * @param seen generation the caller last rendered.
+ * @param timeout_ms maximum time to wait.
+ * @return true if the map changed.
+ */
+bool goldmine_wait_for_change(const goldMine_S *gmp, unsigned int seen, int timeout_ms) {
+    struct timespec ts = {timeout_ms / 1000, (timeout_ms % 1000) * 1000000L};
+
+    if (__atomic_load_n(&gmp->generation, __ATOMIC_ACQUIRE) == seen) {
+        syscall(SYS_futex, &gmp->generation, FUTEX_WAIT, seen, &ts, nullptr, 0);
+    }
+    return __atomic_load_n(&gmp->generation, __ATOMIC_ACQUIRE) != seen;
+}
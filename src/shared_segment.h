@@ -0,0 +1,35 @@
+#ifndef __SHARED_SEGMENT_H__
+#define __SHARED_SEGMENT_H__
+
+#include <stddef.h>
+
+#include "cell_planes.h"
+#include "mine_entrance.h"
+#include "shm_arena.h"
+#include "spatial_index.h"
+#include "timer_wheel.h"
+
+#define GOLDMINE_ARENA_INITIAL (64 * 1024) // arena size a new segment starts with
+#define GOLDMINE_ARENA_RESERVE (64 << 20)  // most the arena may grow to
+#define GOLDMINE_TIMERS 4096               // timers the game's wheel holds
+
+size_t        goldmine_segment_size(unsigned int rows, unsigned int cols);
+size_t        goldmine_reserve_size(unsigned int rows, unsigned int cols);
+size_t        goldmine_walls_offset(unsigned int rows, unsigned int cols);
+size_t        goldmine_arena_offset(unsigned int rows, unsigned int cols);
+size_t        goldmine_used_size(const goldMine_S *gmp);
+size_t        goldmine_arena_used(const goldMine_S *gmp);
+Cell_planes   goldmine_planes(goldMine_S *gmp);
+bool          goldmine_protect_walls(goldMine_S *gmp);
+Shm_arena     goldmine_arena(goldMine_S *gmp, int fd = -1);
+bool          goldmine_format(goldMine_S *gmp, int fd);
+Spatial_index goldmine_spatial(goldMine_S *gmp);
+Timer_wheel   goldmine_timers(goldMine_S *gmp);
+goldMine_S   *goldmine_attach(int fd, int prot, size_t &segment_size);
+void          goldmine_detach(goldMine_S *gmp, size_t segment_size);
+void          goldmine_publish_change(goldMine_S *gmp);
+void          goldmine_wake_watchers(goldMine_S *gmp);
+bool          goldmine_wait_for_change(const goldMine_S *gmp, unsigned int seen,
+                                       int timeout_ms);
+
+#endif // __SHARED_SEGMENT_H__
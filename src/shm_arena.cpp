@@ -0,0 +1,171 @@
+/**
+ * @file shm_arena.cpp
+ * @author Feras Alshehri (falshehri@mail.csuchico.edu)
+ * @brief allocator for variable size structures inside the shared game segment.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+
+#include "shm_arena.h"
+
+// free list heads pack the first block's offset / 16 with a tag that changes on
+// every update, so a head that was popped and pushed back meanwhile (ABA) is told
+// apart from one that did not move
+#define HEAD_OFFSET_BITS 40
+#define HEAD_OFFSET_MASK ((1ull << HEAD_OFFSET_BITS) - 1)
+
+static uint64_t head_offset(uint64_t head) { return (head & HEAD_OFFSET_MASK) << 4; }
+static uint64_t head_next(uint64_t head, shm_offset_t offset) {
+    return (((head >> HEAD_OFFSET_BITS) + 1) << HEAD_OFFSET_BITS) | (offset >> 4);
+}
+
+/**
+ * @brief lay out an empty arena. Done once, by whoever creates the segment.
+ *
+ * @param begin offset of the first block, 16 byte aligned.
+ * @param end size of the segment as created.
+ * @param limit size the segment may grow to.
+ */
+void Shm_arena::format(uint64_t begin, uint64_t end, uint64_t limit) {
+    arena->begin = begin;
+    arena->top   = begin;
+    arena->end   = end;
+    arena->limit = limit;
+    std::memset(arena->free_lists, 0, sizeof(arena->free_lists));
+}
+
+/**
+ * @brief size class of a request, the header included.
+ */
+unsigned int Shm_arena::class_of(size_t size) {
+    size_t       need       = size + sizeof(shm_block_S);
+    unsigned int size_class = SHM_ARENA_MIN_SHIFT;
+    while ((size_class <= SHM_ARENA_MAX_SHIFT) && (((size_t)1 << size_class) < need)) {
+        ++size_class;
+    }
+    return size_class;
+}
+
+/**
+ * @brief take the first block off a free list.
+ *
+ * @return shm_offset_t the block, 0 if the list is empty.
+ */
+shm_offset_t Shm_arena::pop(unsigned int size_class) {
+    uint64_t *head = &arena->free_lists[size_class - SHM_ARENA_MIN_SHIFT];
+    uint64_t  old  = __atomic_load_n(head, __ATOMIC_ACQUIRE);
+
+    while (head_offset(old) != 0) {
+        // the block may be taken and reused under us, then next is garbage and the
+        // tag makes the exchange fail
+        shm_offset_t offset = head_offset(old);
+        uint64_t     next   = __atomic_load_n(&block(offset)->next, __ATOMIC_RELAXED);
+        if (__atomic_compare_exchange_n(head, &old, head_next(old, next), true,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+            return offset;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief put a block on its free list.
+ */
+void Shm_arena::push(unsigned int size_class, shm_offset_t offset) {
+    uint64_t *head = &arena->free_lists[size_class - SHM_ARENA_MIN_SHIFT];
+    uint64_t  old  = __atomic_load_n(head, __ATOMIC_RELAXED);
+
+    do {
+        __atomic_store_n(&block(offset)->next, head_offset(old), __ATOMIC_RELAXED);
+    } while (!__atomic_compare_exchange_n(head, &old, head_next(old, offset), true,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+/**
+ * @brief make the segment at least needed bytes long. The arena at least doubles,
+ *          so growing a byte at a time doesn't cost a system call per block.
+ *          posix_fallocate() rather than ftruncate(): it never shrinks the file, so
+ *          processes growing it at the same time can't undo each other.
+ *
+ * @param needed size the segment must have.
+ * @return false if the view can't grow the segment or it would pass the limit.
+ */
+bool Shm_arena::grow(uint64_t needed) {
+    uint64_t end = __atomic_load_n(&arena->end, __ATOMIC_ACQUIRE);
+    if (needed <= end) { return true; }
+    if ((fd < 0) || (needed > arena->limit)) { return false; }
+
+    uint64_t want = std::max(needed, end + (end - arena->begin));
+    want          = (want + SHM_ARENA_GROW_STEP - 1) / SHM_ARENA_GROW_STEP * SHM_ARENA_GROW_STEP;
+    want          = std::min(want, arena->limit);
+    if (posix_fallocate(fd, 0, want) != 0) { return false; }
+
+    // publish only once the pages are backed, and never move end back
+    while ((end < want) && !__atomic_compare_exchange_n(&arena->end, &end, want, true,
+                                                         __ATOMIC_RELEASE, __ATOMIC_ACQUIRE)) {}
+    return true;
+}
+
+/**
+ * @brief allocate a block. Safe to call from any process at any time, no lock is
+ *          needed.
+ *
+ * @param size bytes needed.
+ * @return shm_offset_t offset of the block, 16 byte aligned; 0 if the request is
+ * too large or the segment can't grow any further.
+ */
+shm_offset_t Shm_arena::allocate(size_t size) {
+    unsigned int size_class = class_of(size);
+    if (size_class > SHM_ARENA_MAX_SHIFT) { return 0; }
+
+    shm_offset_t offset = pop(size_class);
+    if (offset == 0) {
+        uint64_t bytes = 1ull << size_class;
+        uint64_t top   = __atomic_load_n(&arena->top, __ATOMIC_RELAXED);
+        while (true) {
+            if (top + bytes > __atomic_load_n(&arena->end, __ATOMIC_ACQUIRE)) {
+                if (!grow(top + bytes)) { return 0; }
+                continue;
+            }
+            if (__atomic_compare_exchange_n(&arena->top, &top, top + bytes, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        }
+        offset = top;
+    }
+
+    shm_block_S *b = block(offset);
+    b->size_class  = size_class;
+    b->magic       = SHM_ARENA_MAGIC;
+    return offset + sizeof(shm_block_S);
+}
+
+/**
+ * @brief give a block back, to its size class' free list. The segment never
+ *          shrinks.
+ *
+ * @param offset block from allocate().
+ * @return false if offset is not a block in use.
+ */
+bool Shm_arena::release(shm_offset_t offset) {
+    if ((offset < arena->begin + sizeof(shm_block_S)) ||
+        (offset >= __atomic_load_n(&arena->top, __ATOMIC_RELAXED))) {
+        return false;
+    }
+    shm_block_S *b = block(offset - sizeof(shm_block_S));
+    if ((b->magic != SHM_ARENA_MAGIC) || (b->size_class < SHM_ARENA_MIN_SHIFT) ||
+        (b->size_class > SHM_ARENA_MAX_SHIFT)) {
+        return false;
+    }
+    b->magic = 0;
+    push(b->size_class, offset - sizeof(shm_block_S));
+    return true;
+}
@@ -0,0 +1,79 @@
+#ifndef __SHM_ARENA_H__
+#define __SHM_ARENA_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHM_ARENA_MIN_SHIFT 4  // smallest block is 16 bytes, header included
+#define SHM_ARENA_MAX_SHIFT 24 // largest is 16 MB
+#define SHM_ARENA_CLASSES (SHM_ARENA_MAX_SHIFT - SHM_ARENA_MIN_SHIFT + 1)
+#define SHM_ARENA_GROW_STEP (64 * 1024) // the segment grows by multiples of this
+#define SHM_ARENA_MAGIC 0x41524e41u    // "ARNA", in the header of blocks in use
+
+// bytes from the start of the segment, the same in every process whatever address
+// the segment is mapped at. 0 is never a block, it stands for none.
+typedef uint64_t shm_offset_t;
+
+// arena bookkeeping, kept in the segment itself
+struct shm_arena_S {
+    uint64_t begin; // offset of the first block
+    uint64_t top;   // first offset never handed out
+    uint64_t end;   // size of the segment so far, everything below it is backed
+    uint64_t limit; // the segment never grows past this, every process maps this much
+    uint64_t free_lists[SHM_ARENA_CLASSES]; // tagged heads, see Shm_arena::pop()
+};
+
+// in front of every block
+struct shm_block_S {
+    uint64_t next;       // next free block of the class, while free
+    uint32_t size_class; // log2 of the block size
+    uint32_t magic;      // SHM_ARENA_MAGIC while in use
+};
+
+/**
+ * @brief allocator for structures that live in the shared segment, so they need no
+ *          place of their own in the segment layout. Blocks are powers of two and
+ *          freed blocks go on a lock-free free list per size, shared by every
+ *          process. Fresh blocks come off the top of the arena, and when that runs
+ *          into the end of the segment the segment is grown.
+ *
+ *        Every process maps the segment up to limit when it attaches, so growing
+ *        it is only a matter of making the file longer: no process has to remap,
+ *        and pointers into the segment stay valid. Still, store shm_offset_t in
+ *        the segment, never pointers; each process maps it at its own address.
+ *
+ *        This object is a process local view; the state is all in shm_arena_S.
+ */
+class Shm_arena {
+  private:
+    char        *base;
+    shm_arena_S *arena;
+    int          fd; // the segment's shm fd, -1 for a view that can't grow it
+
+    static unsigned int class_of(size_t size);
+    shm_block_S        *block(shm_offset_t offset) const {
+        return (shm_block_S *)(base + offset);
+    }
+    shm_offset_t pop(unsigned int size_class);
+    void         push(unsigned int size_class, shm_offset_t offset);
+    bool         grow(uint64_t needed);
+
+  public:
+    Shm_arena(void *base, shm_arena_S *arena, int fd) : base((char *)base), arena(arena), fd(fd) {}
+
+    void         format(uint64_t begin, uint64_t end, uint64_t limit);
+    shm_offset_t allocate(size_t size);
+    bool         release(shm_offset_t offset);
+
+    template <typename T> T *at(shm_offset_t offset) const {
+        return offset ? (T *)(base + offset) : nullptr;
+    }
+    shm_offset_t offset_of(const void *p) const { return p ? (const char *)p - base : 0; }
+
+    uint64_t get_end() const { return __atomic_load_n(&arena->end, __ATOMIC_ACQUIRE); }
+    uint64_t get_used() const {
+        return __atomic_load_n(&arena->top, __ATOMIC_RELAXED) - arena->begin;
+    }
+};
+
+#endif // __SHM_ARENA_H__
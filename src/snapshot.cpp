@@ -0,0 +1,145 @@
+/**
+ * @file snapshot.cpp
+ * @author Feras Alshehri (falshehri@mail.csuchico.edu)
+ * @brief incremental snapshots of the shared game segment, so a game survives the
+ *          host losing /dev/shm.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "shared_segment.h"
+#include "snapshot.h"
+
+/**
+ * @brief copy the segment into the snapshot file. Pages that are unchanged since
+ *          the previous snapshot into the same file are not written again, so a
+ *          snapshot of a large map only costs the pages players touched. The file
+ *          is marked invalid and synced before the first page is touched, and only
+ *          marked valid again once every page is on disk, so a crash part way
+ *          leaves a file snapshot_map() refuses rather than a torn image.
+ *
+ *          Reads the file back and waits on the disk, so it is meant to be given a
+ *          private copy of the segment taken under the game semaphore (see
+ *          mine_snapshot), not the live segment with the semaphore held.
+ *
+ * @param gmp copy of the game segment.
+ * @param segment_size size of the segment.
+ * @param path snapshot file, created if it does not exist.
+ * @param pages_copied set to the number of pages that changed.
+ * @return true on success.
+ */
+bool snapshot_write(const goldMine_S *gmp, size_t segment_size, std::string path,
+                    size_t &pages_copied) {
+    struct stat st;
+    size_t      file_size = SNAPSHOT_PAGE_SIZE + segment_size;
+
+    pages_copied = 0;
+
+    int fd = open(path.c_str(), O_CREAT | O_RDWR, S_IRUSR | S_IWUSR);
+    if (fd < 0) { return false; }
+
+    // a file from another map can't be diffed against, start it over
+    if ((fstat(fd, &st) == -1) || ((size_t)st.st_size != file_size)) {
+        if ((ftruncate(fd, 0) == -1) || (ftruncate(fd, file_size) == -1)) {
+            close(fd);
+            return false;
+        }
+    }
+
+    char *file =
+        (char *)mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (file == MAP_FAILED) { return false; }
+
+    snapshot_header_S *header = (snapshot_header_S *)file;
+    char              *image  = file + SNAPSHOT_PAGE_SIZE;
+    const char        *live   = (const char *)gmp;
+
+    bool fresh = (header->magic != SNAPSHOT_MAGIC) || (header->segment_size != segment_size);
+    header->magic = 0; // incomplete until the copy is done
+    if (fresh) {
+        header->version         = SNAPSHOT_VERSION;
+        header->segment_size    = segment_size;
+        header->snapshots_taken = 0;
+    }
+    if (msync(file, SNAPSHOT_PAGE_SIZE, MS_SYNC) != 0) {
+        munmap(file, file_size);
+        return false;
+    }
+
+    for (size_t off = 0; off < segment_size; off += SNAPSHOT_PAGE_SIZE) {
+        size_t len = std::min((size_t)SNAPSHOT_PAGE_SIZE, segment_size - off);
+        if (std::memcmp(image + off, live + off, len) != 0) {
+            std::memcpy(image + off, live + off, len);
+            ++pages_copied;
+        }
+    }
+
+    // the image is on disk before the header says it is valid
+    bool ok = (msync(file, file_size, MS_SYNC) == 0);
+    if (ok) {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        header->taken_ns = (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+        header->snapshots_taken++;
+        header->magic = SNAPSHOT_MAGIC;
+        ok            = (msync(file, SNAPSHOT_PAGE_SIZE, MS_SYNC) == 0);
+    }
+    munmap(file, file_size);
+    return ok;
+}
+
+/**
+ * @brief map a snapshot's segment image read-only.
+ *
+ * @param path snapshot file.
+ * @param segment_size set to the size of the segment image on success.
+ * @return const goldMine_S* segment image, or nullptr if the file is not a valid
+ * snapshot. Release with snapshot_unmap().
+ */
+const goldMine_S *snapshot_map(std::string path, size_t &segment_size) {
+    struct stat       st;
+    snapshot_header_S header;
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) { return nullptr; }
+
+    if ((fstat(fd, &st) == -1) || (pread(fd, &header, sizeof(header), 0) != sizeof(header)) ||
+        (header.magic != SNAPSHOT_MAGIC) || (header.version != SNAPSHOT_VERSION) ||
+        ((size_t)st.st_size != SNAPSHOT_PAGE_SIZE + header.segment_size)) {
+        close(fd);
+        return nullptr;
+    }
+
+    void *image = mmap(nullptr, header.segment_size, PROT_READ, MAP_PRIVATE, fd,
+                       SNAPSHOT_PAGE_SIZE);
+    close(fd);
+    if (image == MAP_FAILED) { return nullptr; }
+
+    const goldMine_S *gmp = (const goldMine_S *)image;
+    if (header.segment_size < sizeof(goldMine_S) ||
+        header.segment_size < goldmine_segment_size(gmp->rows, gmp->cols) ||
+        header.segment_size > goldmine_reserve_size(gmp->rows, gmp->cols) ||
+        header.segment_size != goldmine_used_size(gmp)) {
+        munmap(image, header.segment_size);
+        return nullptr;
+    }
+
+    segment_size = header.segment_size;
+    return gmp;
+}
+
+void snapshot_unmap(const goldMine_S *image, size_t segment_size) {
+    munmap((void *)image, segment_size);
+}
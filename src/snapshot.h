@@ -0,0 +1,27 @@
+#ifndef __SNAPSHOT_H__
+#define __SNAPSHOT_H__
+
+#include <stdint.h>
+#include <string>
+
+#include "mine_entrance.h"
+
+#define SNAPSHOT_MAGIC 0x50414e53 // "SNAP"
+#define SNAPSHOT_VERSION 5
+#define SNAPSHOT_PAGE_SIZE 4096
+
+// first page of a snapshot file, the segment image follows page aligned
+struct snapshot_header_S {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t segment_size;
+    uint64_t taken_ns; // CLOCK_REALTIME of the last snapshot
+    uint64_t snapshots_taken;
+};
+
+bool              snapshot_write(const goldMine_S *gmp, size_t segment_size,
+                                 std::string path, size_t &pages_copied);
+const goldMine_S *snapshot_map(std::string path, size_t &segment_size);
+void              snapshot_unmap(const goldMine_S *image, size_t segment_size);
+
+#endif // __SNAPSHOT_H__
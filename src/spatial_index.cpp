@@ -0,0 +1,223 @@
+/**
+ * @file spatial_index.cpp
+ * @author Feras Alshehri (falshehri@mail.csuchico.edu)
+ * @brief grid hash of the players and gold on the map, for proximity queries.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <algorithm>
+
+#include "cell_scan.h"
+#include "spatial_index.h"
+
+/**
+ * @brief hash slots for an index of capacity entities: at least twice as many, so
+ *          the chains stay short.
+ */
+static uint32_t slots_for(uint32_t capacity) {
+    uint32_t slots = SPATIAL_MIN_SLOTS;
+    while (slots < 2 * capacity) { slots <<= 1; }
+    return slots;
+}
+
+/**
+ * @brief bytes an index of capacity entities takes.
+ */
+size_t spatial_index_bytes(uint32_t capacity) {
+    return sizeof(spatial_index_S) + slots_for(capacity) * sizeof(int32_t) +
+           (size_t)capacity * sizeof(spatial_entity_S);
+}
+
+/**
+ * @brief make an empty index.
+ *
+ * @param capacity entities it holds, spatial_index_bytes(capacity) must be mapped.
+ */
+void Spatial_index::format(uint32_t capacity) {
+    index->capacity  = capacity;
+    index->slot_mask = slots_for(capacity) - 1;
+    clear();
+}
+
+/**
+ * @brief empty the index.
+ */
+void Spatial_index::clear() {
+    spatial_entity_S *e = entities();
+    std::fill(index->heads, index->heads + index->slot_mask + 1, SPATIAL_NONE);
+    for (uint32_t i = 0; i < index->capacity; ++i) {
+        e[i]      = {};
+        e[i].next = (i + 1 < index->capacity) ? (int32_t)i + 1 : SPATIAL_NONE;
+    }
+    index->free_list = (index->capacity > 0) ? 0 : SPATIAL_NONE;
+    index->count     = 0;
+}
+
+/**
+ * @brief index everything on a map from scratch: the gold still lying around and
+ *          the players. Used once the gold is placed and after a restore.
+ *
+ * @param planes map planes of the same size as the index.
+ */
+void Spatial_index::rebuild(const Cell_planes &planes) {
+    clear();
+    for (const gold_entry_S &e : planes.get_gold_set().slots) {
+        if (e.kind != 0) { insert(e.key - 1, e.kind); }
+    }
+    // players are a handful of cells, the scan skips the empty ones in blocks
+    const unsigned char *players = planes.get_players();
+    unsigned int         cells   = planes.get_cells();
+    for (unsigned int i = cell_find_any(players, cells, G_ANYP); i < cells;
+         i = i + 1 + cell_find_any(players + i + 1, cells - i - 1, G_ANYP)) {
+        for (unsigned char p = players[i]; p != 0; p &= p - 1) { insert(i, p & -p); }
+    }
+}
+
+/**
+ * @brief add an entity.
+ *
+ * @param cell map cell index.
+ * @param kind a player bit, G_GOLD or G_FOOL.
+ * @return false if the index is full.
+ */
+bool Spatial_index::insert(unsigned int cell, unsigned char kind) {
+    int32_t id = index->free_list;
+    if (id == SPATIAL_NONE) { return false; }
+
+    unsigned int      slot = slot_of_cell(cell);
+    spatial_entity_S &e    = entities()[id];
+    index->free_list       = e.next;
+    e.cell                 = cell;
+    e.kind                 = kind;
+    e.next                 = index->heads[slot];
+    index->heads[slot]     = id;
+    index->count++;
+    return true;
+}
+
+/**
+ * @brief remove an entity.
+ *
+ * @param cell map cell index.
+ * @param kind what to remove from the cell.
+ * @return false if there was no such entity on the cell.
+ */
+bool Spatial_index::remove(unsigned int cell, unsigned char kind) {
+    spatial_entity_S *all = entities();
+    for (int32_t *link = &index->heads[slot_of_cell(cell)]; *link != SPATIAL_NONE;
+         link           = &all[*link].next) {
+        spatial_entity_S &e = all[*link];
+        if ((e.cell == cell) && (e.kind == kind)) {
+            int32_t id       = *link;
+            *link            = e.next;
+            e.kind           = 0;
+            e.next           = index->free_list;
+            index->free_list = id;
+            index->count--;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief move an entity, relinking it only when it changes hash slot.
+ *
+ * @param from cell it is on.
+ * @param to cell it moves to.
+ * @param kind the entity's kind.
+ * @return false if there was no such entity on from.
+ */
+bool Spatial_index::move(unsigned int from, unsigned int to, unsigned char kind) {
+    if (slot_of_cell(from) != slot_of_cell(to)) {
+        return remove(from, kind) && insert(to, kind);
+    }
+    spatial_entity_S *all = entities();
+    for (int32_t id = index->heads[slot_of_cell(from)]; id != SPATIAL_NONE; id = all[id].next) {
+        spatial_entity_S &e = all[id];
+        if ((e.cell == from) && (e.kind == kind)) {
+            e.cell = to;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief find the entities in a rectangle. Buckets that share a hash slot are told
+ *          apart by each entity's own bucket, so nothing is reported twice. When the
+ *          rectangle covers more buckets than there are slots, every slot is walked
+ *          once instead of every bucket.
+ *
+ * @param row0 top row, inclusive. The rectangle is clipped to the map.
+ * @param col0 left col, inclusive.
+ * @param row1 bottom row, inclusive.
+ * @param col1 right col, inclusive.
+ * @param kinds mask of the kinds to report, e.g. G_ANYP or G_GOLD | G_FOOL.
+ * @param found matches are appended here.
+ */
+void Spatial_index::query_rect(int row0, int col0, int row1, int col1, unsigned char kinds,
+                               std::vector<spatial_entity_S> &found) const {
+    row0 = std::max(row0, 0);
+    col0 = std::max(col0, 0);
+    row1 = std::min(row1, (int)rows - 1);
+    col1 = std::min(col1, (int)cols - 1);
+    if ((row0 > row1) || (col0 > col1) || (index->count == 0)) { return; }
+
+    const spatial_entity_S *all    = entities();
+    unsigned int            brow0  = row0 >> SPATIAL_BUCKET_SHIFT;
+    unsigned int            brow1  = (unsigned int)row1 >> SPATIAL_BUCKET_SHIFT;
+    unsigned int            bcol0  = col0 >> SPATIAL_BUCKET_SHIFT;
+    unsigned int            bcol1  = (unsigned int)col1 >> SPATIAL_BUCKET_SHIFT;
+    uint64_t                spread = (uint64_t)(brow1 - brow0 + 1) * (bcol1 - bcol0 + 1);
+    auto                    report = [&](const spatial_entity_S &e) {
+        int row = e.cell / cols, col = e.cell % cols;
+        if ((e.kind & kinds) && (row >= row0) && (row <= row1) && (col >= col0) &&
+            (col <= col1)) {
+            found.push_back(e);
+        }
+    };
+
+    if (spread > index->slot_mask) {
+        for (uint32_t slot = 0; slot <= index->slot_mask; ++slot) {
+            for (int32_t id = index->heads[slot]; id != SPATIAL_NONE; id = all[id].next) {
+                report(all[id]);
+            }
+        }
+        return;
+    }
+
+    for (unsigned int brow = brow0; brow <= brow1; ++brow) {
+        for (unsigned int bcol = bcol0; bcol <= bcol1; ++bcol) {
+            for (int32_t id = index->heads[slot_of_bucket(brow, bcol)]; id != SPATIAL_NONE;
+                 id         = all[id].next) {
+                const spatial_entity_S &e = all[id];
+                if ((((e.cell / cols) >> SPATIAL_BUCKET_SHIFT) != brow) ||
+                    (((e.cell % cols) >> SPATIAL_BUCKET_SHIFT) != bcol)) {
+                    continue; // another bucket hashed to this slot
+                }
+                report(e);
+            }
+        }
+    }
+}
+
+/**
+ * @brief find the entities within radius moves of a cell. Moves go diagonally too,
+ *          so the area is a square.
+ *
+ * @param cell center cell.
+ * @param radius number of moves.
+ * @param kinds mask of the kinds to report.
+ * @param found matches are appended here.
+ */
+void Spatial_index::query_radius(unsigned int cell, unsigned int radius, unsigned char kinds,
+                                 std::vector<spatial_entity_S> &found) const {
+    int row = cell / cols, col = cell % cols;
+    query_rect(row - (int)radius, col - (int)radius, row + (int)radius, col + (int)radius,
+               kinds, found);
+}
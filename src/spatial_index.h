@@ -0,0 +1,83 @@
+#ifndef __SPATIAL_INDEX_H__
+#define __SPATIAL_INDEX_H__
+
+#include <stdint.h>
+#include <vector>
+
+#include "cell_planes.h"
+
+#define SPATIAL_BUCKET_SHIFT 3 // buckets are 8x8 cells
+#define SPATIAL_MIN_SLOTS 64   // bucket hash slots, at least twice the capacity
+#define SPATIAL_MAX_PLAYERS 5
+#define SPATIAL_NONE (-1)
+
+struct spatial_entity_S {
+    uint32_t cell;
+    uint8_t  kind; // player bit, G_GOLD or G_FOOL, 0 = free
+    uint8_t  reserved[3];
+    int32_t  next; // next entity in the same hash slot, or in the free list
+};
+
+// uniform grid over the map, hashed into slots so its size goes with the number of
+// entities rather than the map size. Each slot holds a singly linked list of the
+// entities in the buckets that hash to it. Position independent, so it can live in
+// the game segment's arena.
+struct spatial_index_S {
+    uint32_t capacity;  // entities it holds
+    uint32_t slot_mask; // hash slots - 1, a power of two
+    int32_t  free_list;
+    uint32_t count;
+    int32_t  heads[];   // slot_mask + 1 of them, then capacity spatial_entity_S
+};
+
+size_t spatial_index_bytes(uint32_t capacity);
+
+/**
+ * @brief radius and rectangle queries over the players and gold of a map, in time
+ *          proportional to the buckets the area covers plus what is found, instead
+ *          of a scan of every cell. An area covering more buckets than there are
+ *          slots walks the slots instead, so no query costs more than a walk of
+ *          the whole index.
+ *
+ *        Does not own the index, see goldmine_spatial(). Not synchronized, callers
+ *        hold the game semaphore.
+ */
+class Spatial_index {
+  private:
+    spatial_index_S *index = nullptr;
+    unsigned int     rows  = 0;
+    unsigned int     cols  = 0;
+
+    spatial_entity_S *entities() const {
+        return (spatial_entity_S *)(index->heads + index->slot_mask + 1);
+    }
+    unsigned int slot_of_bucket(unsigned int brow, unsigned int bcol) const {
+        return ((brow * 73856093u) ^ (bcol * 19349663u)) & index->slot_mask;
+    }
+    unsigned int slot_of_cell(unsigned int cell) const {
+        return slot_of_bucket((cell / cols) >> SPATIAL_BUCKET_SHIFT,
+                              (cell % cols) >> SPATIAL_BUCKET_SHIFT);
+    }
+
+  public:
+    Spatial_index() {}
+    Spatial_index(spatial_index_S *index, unsigned int rows, unsigned int cols)
+        : index(index), rows(rows), cols(cols) {}
+
+    unsigned int get_count() const { return index->count; }
+    unsigned int get_capacity() const { return index->capacity; }
+
+    void format(uint32_t capacity);
+    void clear();
+    void rebuild(const Cell_planes &planes);
+    bool insert(unsigned int cell, unsigned char kind);
+    bool remove(unsigned int cell, unsigned char kind);
+    bool move(unsigned int from, unsigned int to, unsigned char kind);
+
+    void query_rect(int row0, int col0, int row1, int col1, unsigned char kinds,
+                    std::vector<spatial_entity_S> &found) const;
+    void query_radius(unsigned int cell, unsigned int radius, unsigned char kinds,
+                      std::vector<spatial_entity_S> &found) const;
+};
+
+#endif // __SPATIAL_INDEX_H__
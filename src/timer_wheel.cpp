@@ -0,0 +1,184 @@
+/**
+ * @file timer_wheel.cpp
+ * @author Feras Alshehri (falshehri@mail.csuchico.edu)
+ * @brief hierarchical timer wheel, O(1) to schedule and cancel whatever the number
+ *          of timers.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <algorithm>
+
+#include "timer_wheel.h"
+
+#define TIMER_WHEEL_SPAN (1ull << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS))
+
+/**
+ * @brief bytes a wheel of capacity timers takes.
+ */
+size_t timer_wheel_bytes(uint32_t capacity) {
+    return sizeof(timer_wheel_S) + (size_t)capacity * sizeof(timer_S);
+}
+
+/**
+ * @brief empty the wheel.
+ *
+ * @param capacity timers it holds, timer_wheel_bytes(capacity) must be mapped.
+ * @param now first tick to run.
+ */
+void Timer_wheel::format(uint32_t capacity, uint64_t now) {
+    wheel->now       = now;
+    wheel->capacity  = capacity;
+    wheel->pending   = 0;
+    wheel->free_list = (capacity > 0) ? 0 : TIMER_NONE;
+    std::fill(wheel->heads, wheel->heads + TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS, TIMER_NONE);
+    for (uint32_t i = 0; i < capacity; ++i) {
+        wheel->timers[i]      = {};
+        wheel->timers[i].next = (i + 1 < capacity) ? i + 1 : TIMER_NONE;
+        wheel->timers[i].slot = TIMER_NONE;
+    }
+}
+
+/**
+ * @brief put a timer in the slot for its tick: level 0 if it is due within 64
+ *          ticks, level 1 within 64^2, and so on. A timer due further out than the
+ *          last level reaches waits in its furthest slot, and is placed again by
+ *          its real tick when that slot comes round.
+ */
+void Timer_wheel::link(uint32_t t) {
+    timer_S &timer = wheel->timers[t];
+    uint64_t due   = std::max(timer.due, wheel->now); // overdue runs on the next tick
+    if (due - wheel->now >= TIMER_WHEEL_SPAN) { due = wheel->now + TIMER_WHEEL_SPAN - 1; }
+
+    unsigned int level = 0;
+    while ((level + 1 < TIMER_WHEEL_LEVELS) &&
+           ((due - wheel->now) >> (TIMER_WHEEL_BITS * (level + 1)))) {
+        ++level;
+    }
+    timer.slot = level * TIMER_WHEEL_SLOTS +
+                 ((due >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1));
+
+    uint32_t &head = wheel->heads[timer.slot];
+    timer.prev     = TIMER_NONE;
+    timer.next     = head;
+    if (head != TIMER_NONE) { wheel->timers[head].prev = t; }
+    head = t;
+}
+
+void Timer_wheel::unlink(uint32_t t) {
+    timer_S &timer = wheel->timers[t];
+    if (timer.prev != TIMER_NONE) {
+        wheel->timers[timer.prev].next = timer.next;
+    } else {
+        wheel->heads[timer.slot] = timer.next;
+    }
+    if (timer.next != TIMER_NONE) { wheel->timers[timer.next].prev = timer.prev; }
+}
+
+void Timer_wheel::release(uint32_t t) {
+    timer_S &timer = wheel->timers[t];
+    timer.slot     = TIMER_NONE;
+    timer.generation++;
+    timer.next       = wheel->free_list;
+    wheel->free_list = t;
+    wheel->pending--;
+}
+
+/**
+ * @brief move the timers of a slot down to the levels below, now that the level
+ *          below has come round to it.
+ */
+void Timer_wheel::cascade(unsigned int level, unsigned int slot) {
+    uint32_t t = wheel->heads[level * TIMER_WHEEL_SLOTS + slot];
+    wheel->heads[level * TIMER_WHEEL_SLOTS + slot] = TIMER_NONE;
+    while (t != TIMER_NONE) {
+        uint32_t next = wheel->timers[t].next;
+        link(t);
+        t = next;
+    }
+}
+
+/**
+ * @brief start a timer.
+ *
+ * @param due tick to fire at; a tick already run fires on the next one.
+ * @param kind what the timer is for, handed back when it fires.
+ * @param arg handed back when it fires.
+ * @return timer_id_t id to cancel it with, 0 if all timers are in use.
+ */
+timer_id_t Timer_wheel::schedule(uint64_t due, uint32_t kind, uint32_t arg) {
+    uint32_t t = wheel->free_list;
+    if (t == TIMER_NONE) { return 0; }
+    wheel->free_list = wheel->timers[t].next;
+    wheel->pending++;
+
+    timer_S &timer = wheel->timers[t];
+    timer.due      = due;
+    timer.kind     = kind;
+    timer.arg      = arg;
+    link(t);
+    return ((timer_id_t)timer.generation << 32) | (t + 1);
+}
+
+/**
+ * @brief is a timer still to fire.
+ */
+bool Timer_wheel::is_pending(timer_id_t id) const {
+    uint32_t t = (uint32_t)id - 1;
+    return (id != 0) && (t < wheel->capacity) && (wheel->timers[t].slot != TIMER_NONE) &&
+           (wheel->timers[t].generation == (uint32_t)(id >> 32));
+}
+
+/**
+ * @brief stop a timer before it fires.
+ *
+ * @return false if it already fired or was cancelled.
+ */
+bool Timer_wheel::cancel(timer_id_t id) {
+    if (!is_pending(id)) { return false; }
+    uint32_t t = (uint32_t)id - 1;
+    unlink(t);
+    release(t);
+    return true;
+}
+
+/**
+ * @brief run every tick up to and including now. The timers due are freed and
+ *          handed back in the order they fire, for the caller to act on; acting
+ *          on them may schedule new timers.
+ *
+ * @param now current tick.
+ * @param fired out, the timers that fired are appended.
+ */
+void Timer_wheel::advance(uint64_t now, std::vector<timer_event_S> &fired) {
+    while (wheel->now <= now) {
+        if (wheel->pending == 0) {
+            __atomic_store_n(&wheel->now, now + 1, __ATOMIC_RELAXED);
+            return;
+        }
+
+        uint64_t tick = wheel->now;
+        // each level the one below just wrapped around into moves down
+        for (unsigned int level = 1; level < TIMER_WHEEL_LEVELS; ++level) {
+            if (tick & ((1ull << (TIMER_WHEEL_BITS * level)) - 1)) { break; }
+            cascade(level, (tick >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1));
+        }
+
+        uint32_t &head = wheel->heads[tick & (TIMER_WHEEL_SLOTS - 1)];
+        uint32_t  t    = head;
+        head           = TIMER_NONE;
+        while (t != TIMER_NONE) {
+            timer_S &timer = wheel->timers[t];
+            uint32_t next  = timer.next;
+            fired.push_back(
+                {((timer_id_t)timer.generation << 32) | (t + 1), timer.due, timer.kind,
+                 timer.arg});
+            release(t);
+            t = next;
+        }
+        __atomic_store_n(&wheel->now, tick + 1, __ATOMIC_RELAXED);
+    }
+}
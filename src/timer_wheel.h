@@ -0,0 +1,80 @@
+#ifndef __TIMER_WHEEL_H__
+#define __TIMER_WHEEL_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#define TIMER_WHEEL_BITS 6 // 64 slots a level
+#define TIMER_WHEEL_SLOTS (1u << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_LEVELS 4 // timers up to 64^4 ticks ahead, later ones wait on the last level
+#define TIMER_NONE 0xFFFFFFFFu
+
+typedef uint64_t timer_id_t; // generation << 32 | timer + 1, 0 = no timer
+
+struct timer_S {
+    uint64_t due;        // tick it fires at
+    uint32_t next;       // in its slot's list or the free list
+    uint32_t prev;       // in its slot's list
+    uint32_t slot;       // level * TIMER_WHEEL_SLOTS + slot, TIMER_NONE while free
+    uint32_t generation; // bumped when the timer is freed, so stale ids miss it
+    uint32_t kind;       // what to do when it fires, up to the user of the wheel
+    uint32_t arg;
+};
+
+// a timer that fired, see Timer_wheel::advance()
+struct timer_event_S {
+    timer_id_t id;
+    uint64_t   due;
+    uint32_t   kind;
+    uint32_t   arg;
+};
+
+// position independent, so it can live in the game segment's arena
+struct timer_wheel_S {
+    uint64_t now; // next tick to run, every earlier one has
+    uint32_t capacity;
+    uint32_t pending;
+    uint32_t free_list;
+    uint32_t heads[TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS];
+    timer_S  timers[]; // capacity of them
+};
+
+size_t timer_wheel_bytes(uint32_t capacity);
+
+/**
+ * @brief hierarchical timer wheel: level 0 has a slot per tick, each level above
+ *          a slot per 64 ticks of the one below. A timer goes in the lowest level
+ *          whose span reaches its tick and moves down a level each time the level
+ *          below wraps around, so scheduling and cancelling are O(1) and a tick
+ *          only touches the timers that fire or move down.
+ *
+ *        Does not own the wheel, see goldmine_timers(). Not synchronized, callers
+ *        hold the game semaphore.
+ */
+class Timer_wheel {
+  private:
+    timer_wheel_S *wheel = nullptr;
+
+    void link(uint32_t t);
+    void unlink(uint32_t t);
+    void release(uint32_t t);
+    void cascade(unsigned int level, unsigned int slot);
+
+  public:
+    Timer_wheel() {}
+    Timer_wheel(timer_wheel_S *wheel) : wheel(wheel) {}
+
+    void       format(uint32_t capacity, uint64_t now);
+    timer_id_t schedule(uint64_t due, uint32_t kind, uint32_t arg);
+    bool       cancel(timer_id_t id);
+    bool       is_pending(timer_id_t id) const;
+    void       advance(uint64_t now, std::vector<timer_event_S> &fired);
+
+    // read without the semaphore to see whether a tick is due, see advance()
+    uint64_t get_now() const { return __atomic_load_n(&wheel->now, __ATOMIC_RELAXED); }
+    uint32_t get_pending() const { return wheel->pending; }
+    uint32_t get_capacity() const { return wheel->capacity; }
+};
+
+#endif // __TIMER_WHEEL_H__
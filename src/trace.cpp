@@ -0,0 +1,104 @@
+/**
+ * @file trace.cpp
+ * @author Feras Alshehri (falshehri@mail.csuchico.edu)
+ * @brief lock-free per-process trace ring buffer with TSC timestamps.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "trace.h"
+
+static trace_event_S         ring[TRACE_RING_EVENTS];
+static std::atomic<uint64_t> ring_head(0);
+static uint64_t              base_tsc = 0; // TSC and monotonic clock sampled together at
+static uint64_t              base_ns  = 0; // the first event, to convert TSC to ns
+
+static uint64_t monotonic_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/**
+ * @brief cheapest available timestamp: the TSC on x86, the monotonic clock elsewhere.
+ *
+ * @return uint64_t timestamp in ticks.
+ */
+static inline uint64_t read_tsc() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return monotonic_ns();
+#endif
+}
+
+static void calibrate() {
+    base_ns  = monotonic_ns();
+    base_tsc = read_tsc();
+    atexit(trace_dump);
+}
+
+/**
+ * @brief record one event. Slots are claimed with a single atomic add, so any thread
+ *          can record without locks; once full the oldest events are overwritten.
+ *
+ * @param name event name, must be a string literal.
+ * @param phase 'B', 'E' or 'i'.
+ */
+void trace_event(const char *name, char phase) {
+    static thread_local uint32_t tid = (uint32_t)syscall(SYS_gettid);
+    static bool                  calibrated = (calibrate(), true);
+    (void)calibrated;
+
+    trace_event_S &e = ring[ring_head.fetch_add(1, std::memory_order_relaxed) %
+                            TRACE_RING_EVENTS];
+    e.tsc            = read_tsc();
+    e.name           = name;
+    e.tid            = tid;
+    e.phase          = phase;
+}
+
+/**
+ * @brief write the ring to the trace file, one "ns phase pid tid name" line per
+ *          event. Registered with atexit() by the first event.
+ */
+void trace_dump() {
+    uint64_t head = ring_head.load();
+    if (head == 0) { return; }
+
+    // second calibration point, spread over the whole run for precision
+    uint64_t end_ns  = monotonic_ns();
+    uint64_t end_tsc = read_tsc();
+    double   ns_per_tick =
+        (end_tsc > base_tsc) ? (double)(end_ns - base_ns) / (end_tsc - base_tsc) : 1.0;
+
+    const char *dir  = getenv(TRACE_DIR_ENV);
+    std::string path = std::string(dir ? dir : "/tmp") + "/goldchase_trace." +
+                       std::to_string(getpid()) + ".txt";
+    FILE *f = fopen(path.c_str(), "w");
+    if (f == nullptr) { return; }
+
+    uint64_t first = (head > TRACE_RING_EVENTS) ? head - TRACE_RING_EVENTS : 0;
+    for (uint64_t i = first; i < head; ++i) {
+        const trace_event_S &e  = ring[i % TRACE_RING_EVENTS];
+        uint64_t             ns = base_ns + (uint64_t)((double)(e.tsc - base_tsc) * ns_per_tick);
+        fprintf(f, "%llu %c %d %u %s\n", (unsigned long long)ns, e.phase, (int)getpid(),
+                e.tid, e.name);
+    }
+    fclose(f);
+}
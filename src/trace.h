@@ -0,0 +1,47 @@
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <stdint.h>
+
+// Trace points compile to nothing unless built with -DGOLDCHASE_TRACE (make TRACE=1).
+// Events go to a per-process ring buffer and are written to
+// $GOLDCHASE_TRACE_DIR/goldchase_trace.<pid>.txt (default /tmp) at exit; merge the
+// files of all players with mine_trace into a Chrome trace.
+
+#define TRACE_RING_EVENTS (1u << 16)
+#define TRACE_DIR_ENV "GOLDCHASE_TRACE_DIR"
+
+struct trace_event_S {
+    uint64_t    tsc;
+    const char *name; // must be a string literal
+    uint32_t    tid;
+    char        phase; // 'B'egin, 'E'nd or 'i'nstant, as in the Chrome trace format
+};
+
+void trace_event(const char *name, char phase);
+void trace_dump();
+
+class Trace_scope {
+  private:
+    const char *name;
+
+  public:
+    Trace_scope(const char *n) : name(n) { trace_event(name, 'B'); }
+    ~Trace_scope() { trace_event(name, 'E'); }
+};
+
+#ifdef GOLDCHASE_TRACE
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_BEGIN(name) trace_event(name, 'B')
+#define TRACE_END(name) trace_event(name, 'E')
+#define TRACE_INSTANT(name) trace_event(name, 'i')
+#define TRACE_SCOPE(name) Trace_scope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+#else
+#define TRACE_BEGIN(name) ((void)0)
+#define TRACE_END(name) ((void)0)
+#define TRACE_INSTANT(name) ((void)0)
+#define TRACE_SCOPE(name) ((void)0)
+#endif
+
+#endif // __TRACE_H__